@@ -0,0 +1,100 @@
+#pragma once
+
+#include "ColorProgram.hpp"
+#include "ColorTextureProgram.hpp"
+
+#include <glm/glm.hpp>
+
+/*
+ * Vertex formats for flat-colored geometry, picked at compile time:
+ *  - DrawVertex< false >: position + color (16 bytes), drawn with ColorProgram;
+ *  - DrawVertex< true >: position + color + texture coordinate (24 bytes), drawn with
+ *    ColorTextureProgram (for real sprites; solid shapes sample a white texture).
+ * Each names its program and describes its layout to a vertex array object,
+ *  so a mode picks the variant once with 'typedef DrawVertex< ... > Vertex;'.
+ */
+
+template< bool Textured_ >
+struct DrawVertex;
+
+template< >
+struct DrawVertex< false > {
+	static constexpr bool Textured = false;
+	typedef ColorProgram Program;
+
+	DrawVertex(glm::vec3 const &Position_, glm::u8vec4 const &Color_) :
+		Position(Position_), Color(Color_) { }
+	glm::vec3 Position;
+	glm::u8vec4 Color;
+
+	//set up the bound vertex array object to read arrays of DrawVertex from the buffer bound to GL_ARRAY_BUFFER:
+	static void bind_attributes(Program const &program) {
+		glVertexAttribPointer(
+			program.Position_vec4, //attribute
+			3, //size
+			GL_FLOAT, //type
+			GL_FALSE, //normalized
+			sizeof(DrawVertex), //stride
+			(GLbyte *)0 + 0 //offset
+		);
+		glEnableVertexAttribArray(program.Position_vec4);
+		//[Note that it is okay to bind a vec3 input to a vec4 attribute -- the w component will be filled with 1.0 automatically]
+
+		glVertexAttribPointer(
+			program.Color_vec4, //attribute
+			4, //size
+			GL_UNSIGNED_BYTE, //type
+			GL_TRUE, //normalized
+			sizeof(DrawVertex), //stride
+			(GLbyte *)0 + 4*3 //offset
+		);
+		glEnableVertexAttribArray(program.Color_vec4);
+	}
+};
+static_assert(sizeof(DrawVertex< false >) == 4*3 + 1*4, "DrawVertex< false > should be packed");
+
+template< >
+struct DrawVertex< true > {
+	static constexpr bool Textured = true;
+	typedef ColorTextureProgram Program;
+
+	DrawVertex(glm::vec3 const &Position_, glm::u8vec4 const &Color_, glm::vec2 const &TexCoord_) :
+		Position(Position_), Color(Color_), TexCoord(TexCoord_) { }
+	glm::vec3 Position;
+	glm::u8vec4 Color;
+	glm::vec2 TexCoord;
+
+	//set up the bound vertex array object to read arrays of DrawVertex from the buffer bound to GL_ARRAY_BUFFER:
+	static void bind_attributes(Program const &program) {
+		glVertexAttribPointer(
+			program.Position_vec4, //attribute
+			3, //size
+			GL_FLOAT, //type
+			GL_FALSE, //normalized
+			sizeof(DrawVertex), //stride
+			(GLbyte *)0 + 0 //offset
+		);
+		glEnableVertexAttribArray(program.Position_vec4);
+
+		glVertexAttribPointer(
+			program.Color_vec4, //attribute
+			4, //size
+			GL_UNSIGNED_BYTE, //type
+			GL_TRUE, //normalized
+			sizeof(DrawVertex), //stride
+			(GLbyte *)0 + 4*3 //offset
+		);
+		glEnableVertexAttribArray(program.Color_vec4);
+
+		glVertexAttribPointer(
+			program.TexCoord_vec2, //attribute
+			2, //size
+			GL_FLOAT, //type
+			GL_FALSE, //normalized
+			sizeof(DrawVertex), //stride
+			(GLbyte *)0 + 4*3 + 4*1 //offset
+		);
+		glEnableVertexAttribArray(program.TexCoord_vec2);
+	}
+};
+static_assert(sizeof(DrawVertex< true >) == 4*3 + 1*4 + 4*2, "DrawVertex< true > should be packed");
@@ -0,0 +1,82 @@
+#include "EntityStore.hpp"
+
+#include <algorithm>
+
+void EntityStore::reset(uint32_t capacity_) {
+	position.assign(capacity_, glm::vec2(0.0f));
+	previous.assign(capacity_, glm::vec2(0.0f));
+	radius.assign(capacity_, glm::vec2(0.0f));
+	velocity.assign(capacity_, glm::vec2(0.0f));
+	color.assign(capacity_, glm::u8vec4(0));
+	kind.assign(capacity_, 0);
+
+	count = 0;
+	index_slot.assign(capacity_, 0);
+	slot_index.assign(capacity_, ~0U);
+	slot_generation.assign(capacity_, 0);
+
+	//hand out low slots first:
+	free_slots.clear();
+	free_slots.reserve(capacity_);
+	for (uint32_t slot = capacity_; slot > 0; --slot) {
+		free_slots.emplace_back(slot - 1);
+	}
+}
+
+EntityStore::Handle EntityStore::create(uint8_t kind_, glm::vec2 const &position_, glm::vec2 const &radius_, glm::vec2 const &velocity_, glm::u8vec4 const &color_) {
+	assert(!full() && "EntityStore is full");
+
+	uint32_t slot = free_slots.back();
+	free_slots.pop_back();
+
+	uint32_t index = count;
+	count += 1;
+	position[index] = position_;
+	previous[index] = position_;
+	radius[index] = radius_;
+	velocity[index] = velocity_;
+	color[index] = color_;
+	kind[index] = kind_;
+
+	index_slot[index] = slot;
+	slot_index[slot] = index;
+
+	Handle handle;
+	handle.slot = slot;
+	handle.generation = slot_generation[slot];
+	return handle;
+}
+
+void EntityStore::destroy_at(uint32_t index) {
+	assert(index < count);
+	uint32_t slot = index_slot[index];
+
+	//move the last entity into the hole:
+	count -= 1;
+	if (index != count) {
+		position[index] = position[count];
+		previous[index] = previous[count];
+		radius[index] = radius[count];
+		velocity[index] = velocity[count];
+		color[index] = color[count];
+		kind[index] = kind[count];
+		index_slot[index] = index_slot[count];
+		slot_index[index_slot[index]] = index;
+	}
+
+	slot_index[slot] = ~0U;
+	slot_generation[slot] += 1; //(outstanding handles to this slot are now stale)
+	free_slots.emplace_back(slot);
+}
+
+void EntityStore::integrate(float elapsed) {
+	glm::vec2 *p = position.data();
+	glm::vec2 const *v = velocity.data();
+	for (uint32_t i = 0; i < count; ++i) {
+		p[i] += v[i] * elapsed;
+	}
+}
+
+void EntityStore::save_previous() {
+	std::copy(position.begin(), position.begin() + count, previous.begin());
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstdint>
+#include <cassert>
+
+/*
+ * EntityStore holds simple rectangular game objects (paddles, balls,
+ *  bullets, ...) as parallel component arrays, so that per-frame work
+ *  is a straight sweep over contiguous memory.
+ *
+ * Live entities are packed into [0, size()) of every component array.
+ *  Destroying one moves the last entity into its place (so order is not
+ *  kept, and loops that destroy should only advance their index when they
+ *  don't destroy).
+ *
+ * Because entities move around, code that needs to refer to a particular
+ *  entity over time keeps a Handle instead of an index. A handle stops
+ *  being alive() once its entity is destroyed, even if the slot is reused.
+ *
+ * Capacity is fixed by reset(), so creating entities never allocates.
+ */
+
+struct EntityStore {
+	struct Handle {
+		uint32_t slot = ~0U;
+		uint32_t generation = 0;
+	};
+
+	void reset(uint32_t capacity);
+
+	uint32_t size() const { return count; }
+	uint32_t capacity() const { return uint32_t(slot_generation.size()); }
+	bool empty() const { return count == 0; }
+	bool full() const { return count == capacity(); }
+
+	Handle create(uint8_t kind, glm::vec2 const &position, glm::vec2 const &radius, glm::vec2 const &velocity = glm::vec2(0.0f), glm::u8vec4 const &color = glm::u8vec4(0xff));
+
+	bool alive(Handle const &handle) const {
+		return handle.slot < capacity() && slot_generation[handle.slot] == handle.generation && slot_index[handle.slot] != ~0U;
+	}
+	//index of a live entity in the component arrays (changes when other entities are destroyed):
+	uint32_t at(Handle const &handle) const {
+		assert(alive(handle));
+		return slot_index[handle.slot];
+	}
+	Handle handle_at(uint32_t index) const {
+		assert(index < count);
+		Handle handle;
+		handle.slot = index_slot[index];
+		handle.generation = slot_generation[handle.slot];
+		return handle;
+	}
+
+	void destroy(Handle const &handle) { destroy_at(at(handle)); }
+	void destroy_at(uint32_t index);
+
+	//----- sweeps over every entity -----
+
+	//position += velocity * elapsed:
+	void integrate(float elapsed);
+	//previous = position (call at the start of an update, so draw() can interpolate):
+	void save_previous();
+
+	//----- components (entries [0, size()) are live) -----
+	std::vector< glm::vec2 > position;
+	std::vector< glm::vec2 > previous; //position as of the last save_previous()
+	std::vector< glm::vec2 > radius;
+	std::vector< glm::vec2 > velocity;
+	std::vector< glm::u8vec4 > color;
+	std::vector< uint8_t > kind; //(meaning is up to the game)
+
+	//----- bookkeeping -----
+	uint32_t count = 0;
+	std::vector< uint32_t > index_slot; //[index] -> slot of the entity stored there
+	std::vector< uint32_t > slot_index; //[slot] -> index of its entity, or ~0U if the slot is free
+	std::vector< uint32_t > slot_generation; //[slot] -> bumped every time the slot's entity is destroyed
+	std::vector< uint32_t > free_slots; //(used as a stack)
+};
@@ -0,0 +1,27 @@
+#include "FixedTimestep.hpp"
+
+#include <cassert>
+#include <cmath>
+
+uint32_t FixedTimestep::advance(float elapsed) {
+	assert(tick > 0.0f);
+
+	//negative elapsed can only come from a misbehaving clock:
+	if (elapsed > 0.0f) accumulator += elapsed;
+
+	float whole = std::floor(accumulator / tick);
+	uint32_t due = (whole > float(UINT32_MAX) ? UINT32_MAX : uint32_t(whole));
+
+	ticks_run = (due < max_ticks_per_frame ? due : max_ticks_per_frame);
+	ticks_dropped = due - ticks_run;
+
+	accumulator -= float(due) * tick;
+	//guard against rounding leaving the accumulator a hair outside [0,tick):
+	if (accumulator < 0.0f) accumulator = 0.0f;
+	if (accumulator >= tick) accumulator = 0.0f;
+
+	total_ticks_run += ticks_run;
+	total_ticks_dropped += ticks_dropped;
+
+	return ticks_run;
+}
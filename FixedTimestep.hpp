@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+ * FixedTimestep converts variable frame times into a whole number of
+ *  fixed-length simulation ticks, so game logic runs at the same rate
+ *  regardless of the display's refresh rate.
+ *
+ * Leftover time (less than one tick) is carried to the next frame and
+ *  exposed as alpha() so that draw() can interpolate between the previous
+ *  and current simulation states.
+ */
+
+struct FixedTimestep {
+	//length of one simulation tick, in seconds:
+	float tick = 1.0f / 120.0f;
+
+	//most ticks that will be run to catch up in one frame;
+	// anything beyond this is dropped (and counted) to avoid a spiral of death:
+	uint32_t max_ticks_per_frame = 12;
+
+	//time that has passed but not yet been simulated (always < tick after advance):
+	float accumulator = 0.0f;
+
+	//counters for the most recent call to advance():
+	uint32_t ticks_run = 0;
+	uint32_t ticks_dropped = 0;
+
+	//running totals since construction:
+	uint64_t total_ticks_run = 0;
+	uint64_t total_ticks_dropped = 0;
+
+	//add 'elapsed' seconds of wall-clock time; returns the number of ticks to run this frame:
+	uint32_t advance(float elapsed);
+
+	//fraction of a tick between the last simulated state and now, in [0,1):
+	float alpha() const { return accumulator / tick; }
+};
@@ -0,0 +1,152 @@
+#include "InputLog.hpp"
+
+#include <fstream>
+#include <stdexcept>
+#include <cstring>
+
+//file layout (native byte order; logs are meant to be replayed on the machine that made them):
+// "tklg" version mode seed window_size.x window_size.y tick max_ticks_per_frame
+// frame_count event_count status_length
+// Frame[frame_count] Event[event_count] char[status_length]
+static char const Magic[4] = {'t','k','l','g'};
+static uint32_t const Version = 1;
+
+void InputLog::add_event(SDL_Event const &evt) {
+	events.emplace_back(pack(evt));
+	pending_events += 1;
+}
+
+void InputLog::end_frame(float elapsed) {
+	frames.emplace_back();
+	frames.back().event_count = pending_events;
+	frames.back().elapsed = elapsed;
+	pending_events = 0;
+}
+
+InputLog::Event InputLog::pack(SDL_Event const &evt) {
+	Event event;
+	event.type = evt.type;
+	event.a = event.b = event.c = 0;
+	if (evt.type == SDL_KEYDOWN || evt.type == SDL_KEYUP) {
+		event.a = evt.key.keysym.sym;
+		event.b = evt.key.keysym.mod;
+		event.c = evt.key.repeat;
+	} else if (evt.type == SDL_MOUSEMOTION) {
+		event.a = int32_t(evt.motion.state);
+		event.b = evt.motion.x;
+		event.c = evt.motion.y;
+	} else if (evt.type == SDL_MOUSEBUTTONDOWN || evt.type == SDL_MOUSEBUTTONUP) {
+		event.a = evt.button.button;
+		event.b = evt.button.x;
+		event.c = evt.button.y;
+	} else if (evt.type == SDL_WINDOWEVENT) {
+		event.a = evt.window.event;
+		event.b = evt.window.data1;
+		event.c = evt.window.data2;
+	}
+	return event;
+}
+
+SDL_Event InputLog::unpack(Event const &event) {
+	SDL_Event evt;
+	std::memset(&evt, 0, sizeof(evt));
+	evt.type = event.type;
+	if (event.type == SDL_KEYDOWN || event.type == SDL_KEYUP) {
+		evt.key.keysym.sym = event.a;
+		evt.key.keysym.mod = uint16_t(event.b);
+		evt.key.repeat = uint8_t(event.c);
+		evt.key.state = uint8_t(event.type == SDL_KEYDOWN);
+	} else if (event.type == SDL_MOUSEMOTION) {
+		evt.motion.state = uint32_t(event.a);
+		evt.motion.x = event.b;
+		evt.motion.y = event.c;
+	} else if (event.type == SDL_MOUSEBUTTONDOWN || event.type == SDL_MOUSEBUTTONUP) {
+		evt.button.button = uint8_t(event.a);
+		evt.button.x = event.b;
+		evt.button.y = event.c;
+		evt.button.state = uint8_t(event.type == SDL_MOUSEBUTTONDOWN);
+	} else if (event.type == SDL_WINDOWEVENT) {
+		evt.window.event = uint8_t(event.a);
+		evt.window.data1 = event.b;
+		evt.window.data2 = event.c;
+	}
+	return evt;
+}
+
+template< typename T >
+static void write_pod(std::ostream &to, T const *data, size_t count) {
+	to.write(reinterpret_cast< char const * >(data), sizeof(T) * count);
+}
+
+template< typename T >
+static void read_pod(std::istream &from, T *data, size_t count) {
+	from.read(reinterpret_cast< char * >(data), sizeof(T) * count);
+}
+
+void InputLog::load(std::string const &filename) {
+	std::ifstream file(filename.c_str(), std::ios::binary);
+	if (!file) {
+		throw std::runtime_error("Failed to open input log '" + filename + "'.");
+	}
+
+	char magic[4];
+	uint32_t version = 0;
+	read_pod(file, magic, 4);
+	read_pod(file, &version, 1);
+	if (!file || std::memcmp(magic, Magic, 4) != 0 || version != Version) {
+		throw std::runtime_error("File '" + filename + "' is not a version " + std::to_string(Version) + " input log.");
+	}
+
+	uint32_t counts[3]; //frames, events, status length
+	read_pod(file, &mode, 1);
+	read_pod(file, &seed, 1);
+	read_pod(file, &window_size.x, 1);
+	read_pod(file, &window_size.y, 1);
+	read_pod(file, &tick, 1);
+	read_pod(file, &max_ticks_per_frame, 1);
+	read_pod(file, counts, 3);
+	if (!file) {
+		throw std::runtime_error("Input log '" + filename + "' has a truncated header.");
+	}
+
+	frames.resize(counts[0]);
+	events.resize(counts[1]);
+	status.resize(counts[2]);
+	read_pod(file, frames.data(), frames.size());
+	read_pod(file, events.data(), events.size());
+	read_pod(file, &status[0], status.size());
+	if (!file) {
+		throw std::runtime_error("Input log '" + filename + "' is truncated.");
+	}
+
+	uint64_t total = 0;
+	for (auto const &frame : frames) {
+		total += frame.event_count;
+	}
+	if (total != events.size()) {
+		throw std::runtime_error("Input log '" + filename + "' has " + std::to_string(events.size()) + " events but its frames use " + std::to_string(total) + ".");
+	}
+	pending_events = 0;
+}
+
+void InputLog::save(std::string const &filename) const {
+	std::ofstream file(filename.c_str(), std::ios::binary);
+
+	uint32_t counts[3] = { uint32_t(frames.size()), uint32_t(events.size() - pending_events), uint32_t(status.size()) };
+	write_pod(file, Magic, 4);
+	write_pod(file, &Version, 1);
+	write_pod(file, &mode, 1);
+	write_pod(file, &seed, 1);
+	write_pod(file, &window_size.x, 1);
+	write_pod(file, &window_size.y, 1);
+	write_pod(file, &tick, 1);
+	write_pod(file, &max_ticks_per_frame, 1);
+	write_pod(file, counts, 3);
+	write_pod(file, frames.data(), frames.size());
+	write_pod(file, events.data(), counts[1]);
+	write_pod(file, status.data(), status.size());
+
+	if (!file) {
+		throw std::runtime_error("Failed to write input log '" + filename + "'.");
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <SDL.h>
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/*
+ * InputLog records everything a play session fed to Mode::current: the
+ *  SDL events passed to handle_event() and each frame's elapsed time.
+ *
+ * Because update() runs in fixed ticks and every mode is seeded, feeding a
+ *  log back through the same loop replays the session exactly, as fast as
+ *  the machine can go. The log also stores the mode's status() at the end
+ *  of the recording so a replay can check that it ended up in the same place.
+ */
+
+struct InputLog {
+	//session setup needed to start the replay the same way:
+	uint32_t mode = 0; //which mode was started (see main.cpp)
+	uint32_t seed = 0;
+	glm::uvec2 window_size = glm::uvec2(0);
+	float tick = 0.0f; //FixedTimestep::tick
+	uint32_t max_ticks_per_frame = 0; //FixedTimestep::max_ticks_per_frame
+
+	//events are stored packed, keeping only the fields modes look at:
+	struct Event {
+		uint32_t type;
+		int32_t a, b, c; //(meaning depends on type; see pack())
+	};
+	static_assert(sizeof(Event) == 16, "Events are written to disk as-is.");
+
+	//each frame is a run of events followed by that frame's elapsed time:
+	struct Frame {
+		uint32_t event_count;
+		float elapsed;
+	};
+	static_assert(sizeof(Frame) == 8, "Frames are written to disk as-is.");
+
+	std::vector< Frame > frames;
+	std::vector< Event > events;
+
+	//Mode::current->status() when the recording stopped:
+	std::string status;
+
+	//recording:
+	void add_event(SDL_Event const &evt);
+	void end_frame(float elapsed);
+
+	static Event pack(SDL_Event const &evt);
+	static SDL_Event unpack(Event const &event);
+
+	//NOTE: load and save throw on error
+	void load(std::string const &filename);
+	void save(std::string const &filename) const;
+
+	//events added since the last end_frame() (not yet part of a frame):
+	uint32_t pending_events = 0;
+};
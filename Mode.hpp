@@ -4,6 +4,7 @@
 #include <glm/glm.hpp>
 
 #include <memory>
+#include <string>
 
 struct Mode : std::enable_shared_from_this< Mode > {
 	virtual ~Mode() { }
@@ -13,12 +14,18 @@ struct Mode : std::enable_shared_from_this< Mode > {
 	//The function should return 'true' if it handled the event.
 	virtual bool handle_event(SDL_Event const &, glm::uvec2 const &window_size) { return false; }
 
-	//update is called at the start of a new frame, after events are handled:
-	// 'elapsed' is time in seconds since the last call to 'update'
+	//update is called zero or more times per frame, after events are handled:
+	// 'elapsed' is the fixed simulation tick length in seconds (see FixedTimestep.hpp)
 	virtual void update(float elapsed) { }
 
 	//draw is called after update:
-	virtual void draw(glm::uvec2 const &drawable_size) = 0;
+	// 'alpha' in [0,1) is how far the current frame is between the last two updates,
+	// and can be used to interpolate moving objects for smooth output
+	virtual void draw(glm::uvec2 const &drawable_size, float alpha) = 0;
+
+	//status is a one-line summary of the game state (score, etc);
+	// replays compare it against the recording to check they played out the same:
+	virtual std::string status() const { return ""; }
 
 	//Mode::current is the Mode to which events are dispatched.
 	// use 'set_current' to change the current Mode (e.g., to switch to a menu)
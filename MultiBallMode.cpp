@@ -0,0 +1,112 @@
+#include "MultiBallMode.hpp"
+
+#include <algorithm>
+
+MultiBallMode::MultiBallMode(uint32_t ball_count, uint32_t seed) : sim(ball_count, glm::vec2(7.0f, 5.0f), seed) {
+}
+
+bool MultiBallMode::handle_event(SDL_Event const &evt, glm::uvec2 const &window_size) {
+
+	if (evt.type == SDL_MOUSEMOTION) {
+		//convert mouse from window pixels (top-left origin, +y is down) to clip space ([-1,1]x[-1,1], +y is up):
+		glm::vec2 clip_mouse = glm::vec2(
+			(evt.motion.x + 0.5f) / window_size.x * 2.0f - 1.0f,
+			(evt.motion.y + 0.5f) / window_size.y *-2.0f + 1.0f
+		);
+		sim.left_paddle.y = (clip_to_court * glm::vec3(clip_mouse, 1.0f)).y;
+	}
+
+	return false;
+}
+
+void MultiBallMode::update(float elapsed) {
+	sim.update(elapsed);
+}
+
+std::string MultiBallMode::status() const {
+	return std::to_string(sim.left_points) + " : " + std::to_string(sim.right_points) + ", " + std::to_string(sim.paddle_hits) + " paddle hits";
+}
+
+void MultiBallMode::draw(glm::uvec2 const &drawable_size, float alpha) {
+	//some nice colors from the course web page:
+	#define HEX_TO_U8VEC4( HX ) (glm::u8vec4( (HX >> 24) & 0xff, (HX >> 16) & 0xff, (HX >> 8) & 0xff, (HX) & 0xff ))
+	const glm::u8vec4 bg_color = HEX_TO_U8VEC4(0x193b59ff);
+	const glm::u8vec4 fg_color = HEX_TO_U8VEC4(0xf2d2b6ff);
+	const glm::u8vec4 ball_color = HEX_TO_U8VEC4(0xf2ad94ff);
+	#undef HEX_TO_U8VEC4
+
+	//other useful drawing constants:
+	const float wall_radius = 0.1f;
+	const float padding = 0.3f; //padding between outside of walls and edge of window
+
+	glm::vec2 const &court_radius = sim.court_radius;
+
+	//---- submit rectangles ----
+
+	Renderer2D &renderer = *Renderer2D::current;
+
+	//inline helper function for rectangle drawing:
+	auto draw_rectangle = [&renderer](glm::vec2 const &center, glm::vec2 const &radius, glm::u8vec4 const &color) {
+		//(everything is in one layer, so it draws in the order submitted)
+		renderer.rect(0, center, radius, color);
+	};
+
+	//walls:
+	draw_rectangle(glm::vec2(-court_radius.x-wall_radius, 0.0f), glm::vec2(wall_radius, court_radius.y + 2.0f * wall_radius), fg_color);
+	draw_rectangle(glm::vec2( court_radius.x+wall_radius, 0.0f), glm::vec2(wall_radius, court_radius.y + 2.0f * wall_radius), fg_color);
+	draw_rectangle(glm::vec2( 0.0f,-court_radius.y-wall_radius), glm::vec2(court_radius.x, wall_radius), fg_color);
+	draw_rectangle(glm::vec2( 0.0f, court_radius.y+wall_radius), glm::vec2(court_radius.x, wall_radius), fg_color);
+
+	//paddles and balls, 'alpha' of the way from where they were before the last update to where they are now, as in PongMode:
+	// (the left paddle follows the mouse, so it isn't interpolated)
+	draw_rectangle(sim.left_paddle, sim.paddle_radius, fg_color);
+	draw_rectangle(glm::mix(sim.previous_right_paddle, sim.right_paddle, alpha), sim.paddle_radius, fg_color);
+
+	for (uint32_t i = 0; i < sim.ball_count; ++i) {
+		glm::vec2 at = glm::mix(glm::vec2(sim.previous_x[i], sim.previous_y[i]), glm::vec2(sim.ball_x[i], sim.ball_y[i]), alpha);
+		draw_rectangle(at, sim.ball_radius, ball_color);
+	}
+
+	//------ compute court-to-window transform ------
+
+	//compute area that should be visible:
+	glm::vec2 scene_min = -court_radius - glm::vec2(2.0f * wall_radius + padding);
+	glm::vec2 scene_max = court_radius + glm::vec2(2.0f * wall_radius + padding);
+
+	//compute window aspect ratio:
+	float aspect = drawable_size.x / float(drawable_size.y);
+	//we'll scale the x coordinate by 1.0 / aspect to make sure things stay square.
+
+	//compute scale factor for court given that...
+	float scale = std::min(
+		(2.0f * aspect) / (scene_max.x - scene_min.x), //... x must fit in [-aspect,aspect] ...
+		(2.0f) / (scene_max.y - scene_min.y) //... y must fit in [-1,1].
+	);
+
+	glm::vec2 center = 0.5f * (scene_max + scene_min);
+
+	//build matrix that scales and translates appropriately:
+	glm::mat4 court_to_clip = glm::mat4(
+		glm::vec4(scale / aspect, 0.0f, 0.0f, 0.0f),
+		glm::vec4(0.0f, scale, 0.0f, 0.0f),
+		glm::vec4(0.0f, 0.0f, 1.0f, 0.0f),
+		glm::vec4(-center.x * (scale / aspect), -center.y * scale, 0.0f, 1.0f)
+	);
+	//NOTE: glm matrices are specified in *Column-Major* order,
+	// so each line above is specifying a *column* of the matrix(!)
+
+	//also build the matrix that takes clip coordinates to court coordinates (used for mouse handling):
+	clip_to_court = glm::mat3x2(
+		glm::vec2(aspect / scale, 0.0f),
+		glm::vec2(0.0f, 1.0f / scale),
+		glm::vec2(center.x, center.y)
+	);
+
+	//---- actual drawing ----
+
+	//clear the color buffer:
+	glClearColor(bg_color.r / 255.0f, bg_color.g / 255.0f, bg_color.b / 255.0f, bg_color.a / 255.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	renderer.flush(court_to_clip);
+}
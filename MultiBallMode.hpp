@@ -0,0 +1,32 @@
+#include "Renderer2D.hpp"
+#include "MultiBallSim.hpp"
+
+#include "Mode.hpp"
+#include "GL.hpp"
+
+#include <glm/glm.hpp>
+
+/*
+ * MultiBallMode plays MultiBallSim: Pong with thousands of balls at once.
+ * The mouse moves the left paddle, as in PongMode.
+ */
+
+struct MultiBallMode : Mode {
+	MultiBallMode(uint32_t ball_count = 5000, uint32_t seed = 0);
+
+	//functions called by main loop:
+	virtual bool handle_event(SDL_Event const &, glm::uvec2 const &window_size) override;
+	virtual void update(float elapsed) override;
+	virtual void draw(glm::uvec2 const &drawable_size, float alpha) override;
+	virtual std::string status() const override;
+
+	//----- game state -----
+	MultiBallSim sim;
+
+	//matrix that maps from clip coordinates to court-space coordinates:
+	glm::mat3x2 clip_to_court = glm::mat3x2(1.0f);
+	// computed in draw() as the inverse of OBJECT_TO_CLIP
+	// (stored here so that the mouse handling code can use it to position the paddle)
+
+	//(everything is drawn as solid rectangles through Renderer2D)
+};
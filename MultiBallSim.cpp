@@ -0,0 +1,231 @@
+#include "MultiBallSim.hpp"
+
+#include "aabb_overlap.hpp"
+#include "bits.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+#if defined(__AVX2__)
+	#define MULTIBALL_AVX2
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define MULTIBALL_SSE2
+	#include <emmintrin.h>
+#endif
+
+//seconds since an arbitrary point, for phase timings:
+static double now() {
+	return std::chrono::duration< double >(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+}
+
+static uint32_t count_bits(uint32_t bits) {
+	uint32_t count = 0;
+	while (bits) {
+		bits &= bits - 1;
+		count += 1;
+	}
+	return count;
+}
+
+MultiBallSim::MultiBallSim(uint32_t ball_count_, glm::vec2 const &court_radius_, uint32_t seed) :
+	court_radius(court_radius_), ball_count(ball_count_), rng(seed) {
+
+	left_paddle = glm::vec2(-court_radius.x + 0.5f, 0.0f);
+	right_paddle = glm::vec2( court_radius.x - 0.5f, 0.0f);
+	previous_right_paddle = right_paddle;
+
+	//all storage is allocated up front; update() never allocates:
+	ball_x.resize(ball_count); ball_y.resize(ball_count);
+	previous_x.resize(ball_count); previous_y.resize(ball_count);
+	ball_vx.resize(ball_count); ball_vy.resize(ball_count);
+	ball_rx.assign(ball_count, ball_radius.x); ball_ry.assign(ball_count, ball_radius.y);
+	hit_words.resize(2 * size_t(aabb_mask_words(ball_count))); //(one mask per paddle)
+
+	//scatter balls between the paddles, heading every which way (but not too steeply):
+	std::uniform_real_distribution< float > x_dist(-0.8f * right_paddle.x, 0.8f * right_paddle.x);
+	std::uniform_real_distribution< float > y_dist(-court_radius.y + ball_radius.y, court_radius.y - ball_radius.y);
+	std::uniform_real_distribution< float > angle_dist(-1.2f, 1.2f);
+	std::uniform_int_distribution< int > side_dist(0, 1);
+	for (uint32_t i = 0; i < ball_count; ++i) {
+		ball_x[i] = x_dist(rng);
+		ball_y[i] = y_dist(rng);
+		float angle = angle_dist(rng);
+		ball_vx[i] = (side_dist(rng) ? 1.0f : -1.0f) * ball_speed * std::cos(angle);
+		ball_vy[i] = ball_speed * std::sin(angle);
+	}
+	previous_x = ball_x;
+	previous_y = ball_y;
+}
+
+void MultiBallSim::update(float elapsed) {
+	double before = now();
+	//remember where things were so draw() can interpolate:
+	// (the arrays are already the right size, so this copies without allocating)
+	previous_x = ball_x;
+	previous_y = ball_y;
+	previous_right_paddle = right_paddle;
+	integrate(elapsed);
+	double after_integrate = now();
+	collide_paddles(elapsed);
+	double after_paddles = now();
+
+	timings.integrate = after_integrate - before;
+	timings.paddles = after_paddles - after_integrate;
+}
+
+//Each ball moves by v * elapsed; a ball that ends up past a wall (|p| > limit)
+// is mirrored back across it and its velocity turned away from the wall.
+//All three code paths do the same float operations in the same order, so they agree exactly.
+
+//one coordinate of one ball; returns +1 / -1 if it bounced off the high / low wall:
+static inline int step_scalar(float &p, float &v, float elapsed, float limit) {
+	p = p + v * elapsed;
+	bool hi = p > limit;
+	bool lo = p < -limit;
+	float a = std::abs(v);
+	p = (hi ? (limit + limit) - p : p);
+	p = (lo ? (-limit - limit) - p : p);
+	p = std::min(std::max(p, -limit), limit); //(a ball fast enough to cross the whole court just stops at the far wall)
+	v = (hi ? -a : v);
+	v = (lo ? a : v);
+	return int(hi) - int(lo);
+}
+
+static void integrate_range_scalar(MultiBallSim &sim, uint32_t begin, uint32_t end, float elapsed, glm::vec2 limit) {
+	for (uint32_t i = begin; i < end; ++i) {
+		int side = step_scalar(sim.ball_x[i], sim.ball_vx[i], elapsed, limit.x);
+		step_scalar(sim.ball_y[i], sim.ball_vy[i], elapsed, limit.y);
+		sim.left_points += (side > 0 ? 1 : 0);
+		sim.right_points += (side < 0 ? 1 : 0);
+	}
+}
+
+void MultiBallSim::integrate_scalar(float elapsed) {
+	integrate_range_scalar(*this, 0, ball_count, elapsed, court_radius - ball_radius);
+}
+
+void MultiBallSim::integrate(float elapsed) {
+	glm::vec2 limit = court_radius - ball_radius;
+	uint32_t i = 0;
+
+#if defined(MULTIBALL_AVX2)
+	__m256 const dt = _mm256_set1_ps(elapsed);
+	__m256 const sign = _mm256_set1_ps(-0.0f);
+	//(p, v) of 8 balls along one axis; sets *hi_bits, *lo_bits to which bounced off each wall:
+	auto step = [&](float *p_, float *v_, float limit, uint32_t *hi_bits, uint32_t *lo_bits) {
+		__m256 const lim = _mm256_set1_ps(limit), neg_lim = _mm256_set1_ps(-limit);
+		__m256 p = _mm256_loadu_ps(p_), v = _mm256_loadu_ps(v_);
+		p = _mm256_add_ps(p, _mm256_mul_ps(v, dt));
+		__m256 hi = _mm256_cmp_ps(p, lim, _CMP_GT_OQ);
+		__m256 lo = _mm256_cmp_ps(p, neg_lim, _CMP_LT_OQ);
+		__m256 a = _mm256_andnot_ps(sign, v);
+		p = _mm256_blendv_ps(p, _mm256_sub_ps(_mm256_add_ps(lim, lim), p), hi);
+		p = _mm256_blendv_ps(p, _mm256_sub_ps(_mm256_sub_ps(neg_lim, lim), p), lo);
+		p = _mm256_min_ps(_mm256_max_ps(p, neg_lim), lim);
+		v = _mm256_blendv_ps(v, _mm256_or_ps(a, sign), hi);
+		v = _mm256_blendv_ps(v, a, lo);
+		_mm256_storeu_ps(p_, p);
+		_mm256_storeu_ps(v_, v);
+		*hi_bits = uint32_t(_mm256_movemask_ps(hi));
+		*lo_bits = uint32_t(_mm256_movemask_ps(lo));
+	};
+	for (; i + 8 <= ball_count; i += 8) {
+		uint32_t hi, lo, unused_hi, unused_lo;
+		step(&ball_x[i], &ball_vx[i], limit.x, &hi, &lo);
+		step(&ball_y[i], &ball_vy[i], limit.y, &unused_hi, &unused_lo);
+		left_points += count_bits(hi);
+		right_points += count_bits(lo);
+	}
+#elif defined(MULTIBALL_SSE2)
+	__m128 const dt = _mm_set1_ps(elapsed);
+	__m128 const sign = _mm_set1_ps(-0.0f);
+	//(SSE2 has no blend, so selects are and / andnot / or)
+	auto select = [](__m128 mask, __m128 if_set, __m128 if_clear) {
+		return _mm_or_ps(_mm_and_ps(mask, if_set), _mm_andnot_ps(mask, if_clear));
+	};
+	//(p, v) of 4 balls along one axis; sets *hi_bits, *lo_bits to which bounced off each wall:
+	auto step = [&](float *p_, float *v_, float limit, uint32_t *hi_bits, uint32_t *lo_bits) {
+		__m128 const lim = _mm_set1_ps(limit), neg_lim = _mm_set1_ps(-limit);
+		__m128 p = _mm_loadu_ps(p_), v = _mm_loadu_ps(v_);
+		p = _mm_add_ps(p, _mm_mul_ps(v, dt));
+		__m128 hi = _mm_cmpgt_ps(p, lim);
+		__m128 lo = _mm_cmplt_ps(p, neg_lim);
+		__m128 a = _mm_andnot_ps(sign, v);
+		p = select(hi, _mm_sub_ps(_mm_add_ps(lim, lim), p), p);
+		p = select(lo, _mm_sub_ps(_mm_sub_ps(neg_lim, lim), p), p);
+		p = _mm_min_ps(_mm_max_ps(p, neg_lim), lim);
+		v = select(hi, _mm_or_ps(a, sign), v);
+		v = select(lo, a, v);
+		_mm_storeu_ps(p_, p);
+		_mm_storeu_ps(v_, v);
+		*hi_bits = uint32_t(_mm_movemask_ps(hi));
+		*lo_bits = uint32_t(_mm_movemask_ps(lo));
+	};
+	for (; i + 4 <= ball_count; i += 4) {
+		uint32_t hi, lo, unused_hi, unused_lo;
+		step(&ball_x[i], &ball_vx[i], limit.x, &hi, &lo);
+		step(&ball_y[i], &ball_vy[i], limit.y, &unused_hi, &unused_lo);
+		left_points += count_bits(hi);
+		right_points += count_bits(lo);
+	}
+#endif
+
+	integrate_range_scalar(*this, i, ball_count, elapsed, limit);
+}
+
+void MultiBallSim::collide_paddles(float elapsed) {
+	//right paddle sweeps up and down; both stay in the court:
+	right_paddle.y += right_paddle_direction * paddle_speed * elapsed;
+	float limit = court_radius.y - paddle_radius.y;
+	if (right_paddle.y > limit) right_paddle_direction = -1.0f;
+	if (right_paddle.y < -limit) right_paddle_direction = 1.0f;
+	right_paddle.y = std::min(std::max(right_paddle.y, -limit), limit);
+	left_paddle.y = std::min(std::max(left_paddle.y, -limit), limit);
+
+	AABBSoA balls;
+	balls.x = ball_x.data();
+	balls.y = ball_y.data();
+	balls.rx = ball_rx.data();
+	balls.ry = ball_ry.data();
+	balls.count = ball_count;
+
+	//find the balls that overlap each paddle, both paddles in one batch:
+	// (the paddles are far apart, so bouncing a ball off one can't change whether it overlaps the other)
+	glm::vec2 const paddles[2] = { left_paddle, right_paddle };
+	glm::vec2 const radii[2] = { paddle_radius, paddle_radius };
+	if (!aabb_overlap_masks(2, paddles, radii, balls, hit_words.data())) return;
+
+	//bounce every ball that overlaps a paddle off its nearer side (in x), like PongSim does:
+	uint32_t words = aabb_mask_words(ball_count);
+	for (uint32_t p = 0; p < 2; ++p) {
+		glm::vec2 const &paddle = paddles[p];
+		glm::vec2 reach = paddle_radius + ball_radius;
+		uint64_t const *hits = &hit_words[size_t(p) * words];
+		for (uint32_t w = 0; w < words; ++w) {
+			for (uint64_t bits = hits[w]; bits; bits &= bits - 1) {
+				uint32_t i = w * 64 + lowest_set_bit(bits);
+
+				float side = (ball_x[i] > paddle.x ? 1.0f : -1.0f);
+				ball_x[i] = paddle.x + side * reach.x;
+				ball_vx[i] = side * std::abs(ball_vx[i]);
+				//warp y velocity based on offset from paddle center:
+				float vel = (ball_y[i] - paddle.y) / reach.y * ball_speed;
+				ball_vy[i] = glm::mix(ball_vy[i], vel, 0.75f);
+				paddle_hits += 1;
+			}
+		}
+	}
+}
+
+char const *MultiBallSim::integrate_path() {
+#if defined(MULTIBALL_AVX2)
+	return "avx2";
+#elif defined(MULTIBALL_SSE2)
+	return "sse2";
+#else
+	return "scalar";
+#endif
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Pcg32.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstdint>
+
+/*
+ * MultiBallSim is a stress-test variant of Pong: thousands of small balls
+ *  bouncing around one court between two paddles.
+ *
+ * Balls are stored as parallel arrays. Moving them and bouncing them off
+ *  the walls is one pass that is vectorized like aabb_overlap (AVX2 with
+ *  -mavx2, SSE2 on other x86 builds, scalar elsewhere); walls are handled
+ *  with compare masks and selects rather than branches. Paddle hits are
+ *  found with aabb_overlap_masks, one batched test of both paddles.
+ *
+ * Like PongSim, it has no SDL or OpenGL dependencies.
+ */
+
+struct MultiBallSim {
+	MultiBallSim(uint32_t ball_count, glm::vec2 const &court_radius = glm::vec2(7.0f, 5.0f), uint32_t seed = 0);
+
+	//advance the simulation by 'elapsed' seconds:
+	void update(float elapsed);
+
+	//----- settings -----
+	glm::vec2 court_radius;
+	glm::vec2 paddle_radius = glm::vec2(0.2f, 1.0f);
+	glm::vec2 ball_radius = glm::vec2(0.05f, 0.05f);
+	float ball_speed = 4.0f;
+	float paddle_speed = 3.0f; //(the right paddle sweeps up and down on its own)
+
+	//----- input -----
+	//the left paddle is placed by the player (clamped to the court on the next update):
+	glm::vec2 left_paddle;
+
+	//----- state -----
+	glm::vec2 right_paddle;
+	float right_paddle_direction = 1.0f;
+
+	uint32_t ball_count;
+	std::vector< float > ball_x, ball_y, ball_vx, ball_vy;
+	//ball and right paddle positions as of the start of the last update (so draw() can interpolate):
+	std::vector< float > previous_x, previous_y;
+	glm::vec2 previous_right_paddle;
+	std::vector< float > ball_rx, ball_ry; //(constant; kept as arrays for aabb_overlap_mask)
+	std::vector< uint64_t > hit_words; //scratch: aabb_overlap_masks output (left paddle's mask, then right's)
+
+	//----- statistics -----
+	uint64_t left_points = 0; //balls that reached the right wall
+	uint64_t right_points = 0; //balls that reached the left wall
+	uint64_t paddle_hits = 0;
+
+	//seconds spent in each phase of the most recent update():
+	struct Timings {
+		double integrate = 0.0; //save previous positions, move balls and bounce them off the walls
+		double paddles = 0.0; //move paddles, find and bounce balls that hit them
+		double total() const { return integrate + paddles; }
+	} timings;
+
+	GameRng rng; //(seeded by the constructor)
+
+	//----- update phases -----
+	void integrate(float elapsed);
+	void integrate_scalar(float elapsed); //same results as integrate(), never vectorized (for reference and benchmarking)
+	void collide_paddles(float elapsed);
+
+	//name of the code path integrate() uses ("avx2", "sse2", or "scalar"):
+	static char const *integrate_path();
+};
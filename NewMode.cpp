@@ -1,171 +1,74 @@
 #include "NewMode.hpp"
+#include "bits.hpp"
 
-//for the GL_ERRORS() macro:
-#include "gl_errors.hpp"
+//for checking that draw() doesn't allocate:
+#include "allocation_count.hpp"
 
-//for glm::value_ptr() :
-#include <glm/gtc/type_ptr.hpp>
-
-#include <random>
 #include <iostream>
+#include <algorithm>
+#include <cassert>
 
-NewMode::NewMode() {
-	{ //initialize enemies
-		enemy_positions.clear();
-		float starting_y = player.y + enemy_interval;
-		while (starting_y < court_radius.y) {
-			add_enemies(enemy_positions, starting_y, 2);
-			starting_y += enemy_interval;
-		}
-		spawn_y = starting_y;
-	}
-	std::cout << "Score: 0";
-
-	//----- allocate OpenGL resources -----
-	{ //vertex buffer:
-		glGenBuffers(1, &vertex_buffer);
-		//for now, buffer will be un-filled.
+NewMode::NewMode(uint32_t seed, uint32_t rows_ahead) :
+	row_generator(rows_ahead ? new RowGenerator(seed, rows_ahead) : nullptr),
+	sim(glm::vec2(3.0f, 7.0f), seed, TankTuning(), row_generator.get()) {
+}
 
-		GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+NewMode::~NewMode() {
+	flush_console();
+	if (bot_playing && bot.decisions) {
+		std::cout << "Bot: " << bot.decisions << " decisions, " << bot.nodes_per_second() * 1e-6 << " million nodes per second, "
+		          << bot.seconds_per_decision() * 1e6 << " us per decision (worst " << bot.worst_decision_seconds * 1e6 << " us, worst frame " << std::max(bot.worst_frame_seconds, bot.frame_seconds) * 1e6 << " us), "
+		          << bot.reused_plans << " ticks on an earlier plan, mean depth " << bot.mean_depth() << "." << std::endl;
 	}
-
-	{ //vertex array mapping buffer for color_texture_program:
-		//ask OpenGL to fill vertex_buffer_for_color_texture_program with the name of an unused vertex array object:
-		glGenVertexArrays(1, &vertex_buffer_for_color_texture_program);
-
-		//set vertex_buffer_for_color_texture_program as the current vertex array object:
-		glBindVertexArray(vertex_buffer_for_color_texture_program);
-
-		//set vertex_buffer as the source of glVertexAttribPointer() commands:
-		glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
-
-		//set up the vertex array object to describe arrays of PongMode::Vertex:
-		glVertexAttribPointer(
-			color_texture_program.Position_vec4, //attribute
-			3, //size
-			GL_FLOAT, //type
-			GL_FALSE, //normalized
-			sizeof(Vertex), //stride
-			(GLbyte*)0 + 0 //offset
-		);
-		glEnableVertexAttribArray(color_texture_program.Position_vec4);
-		//[Note that it is okay to bind a vec3 input to a vec4 attribute -- the w component will be filled with 1.0 automatically]
-
-		glVertexAttribPointer(
-			color_texture_program.Color_vec4, //attribute
-			4, //size
-			GL_UNSIGNED_BYTE, //type
-			GL_TRUE, //normalized
-			sizeof(Vertex), //stride
-			(GLbyte*)0 + 4 * 3 //offset
-		);
-		glEnableVertexAttribArray(color_texture_program.Color_vec4);
-
-		glVertexAttribPointer(
-			color_texture_program.TexCoord_vec2, //attribute
-			2, //size
-			GL_FLOAT, //type
-			GL_FALSE, //normalized
-			sizeof(Vertex), //stride
-			(GLbyte*)0 + 4 * 3 + 4 * 1 //offset
-		);
-		glEnableVertexAttribArray(color_texture_program.TexCoord_vec2);
-
-		//done referring to vertex_buffer, so unbind it:
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-		//done setting up vertex array object, so unbind it:
-		glBindVertexArray(0);
-
-		GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+	if (row_generator) {
+		std::cout << "Row generator: " << row_generator->pops << " rows popped, mean queue depth " << row_generator->mean_depth()
+		          << " (min " << (row_generator->pops ? row_generator->min_depth : 0) << " of " << row_generator->ring.size() << "), "
+		          << row_generator->stalls << " stalls." << std::endl;
 	}
-
-	{ //solid white texture:
-		//ask OpenGL to fill white_tex with the name of an unused texture object:
-		glGenTextures(1, &white_tex);
-
-		//bind that texture object as a GL_TEXTURE_2D-type texture:
-		glBindTexture(GL_TEXTURE_2D, white_tex);
-
-		//upload a 1x1 image of solid white to the texture:
-		glm::uvec2 size = glm::uvec2(1, 1);
-		std::vector< glm::u8vec4 > data(size.x * size.y, glm::u8vec4(0xff, 0xff, 0xff, 0xff));
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size.x, size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, data.data());
-
-		//set filtering and wrapping parameters:
-		//(it's a bit silly to mipmap a 1x1 texture, but I'm doing it because you may want to use this code to load different sizes of texture)
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-		//since texture uses a mipmap and we haven't uploaded one, instruct opengl to make one for us:
-		glGenerateMipmap(GL_TEXTURE_2D);
-
-		//Okay, texture uploaded, can unbind it:
-		glBindTexture(GL_TEXTURE_2D, 0);
-
-		GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+	if (court_layer.rebuilds) {
+		std::cout << "Retained layers: court " << court_layer.report() << "; HUD rectangles " << hud_rects_layer.report()
+		          << ", HUD triangles " << hud_vertices_layer.report() << "." << std::endl;
 	}
 }
 
-NewMode::~NewMode() {
-
-	//----- free OpenGL resources -----
-	glDeleteBuffers(1, &vertex_buffer);
-	vertex_buffer = 0;
-
-	glDeleteVertexArrays(1, &vertex_buffer_for_color_texture_program);
-	vertex_buffer_for_color_texture_program = 0;
-
-	glDeleteTextures(1, &white_tex);
-	white_tex = 0;
-}
-
 bool NewMode::handle_event(SDL_Event const& evt, glm::uvec2 const& window_size) {
+	if (bot_playing) return false;
+
 	if (evt.type == SDL_KEYDOWN) {
 		auto keyEvent = evt.key.keysym.sym;
-		if (!left_locked && (keyEvent == SDLK_a || keyEvent == SDLK_LEFT)) {
-			go_left = true;
-			go_right = false;
-			left_locked = true;
+		if (keyEvent == SDLK_a || keyEvent == SDLK_LEFT) {
+			sim.left_down();
 		}
-		else if (!right_locked && (keyEvent == SDLK_d || keyEvent == SDLK_RIGHT)) {
-			go_right = true;
-			go_left = false;
-			right_locked = true;
+		else if (keyEvent == SDLK_d || keyEvent == SDLK_RIGHT) {
+			sim.right_down();
 		}
-		else if (!shoot_locked && keyEvent == SDLK_SPACE && bullet_available > 0) {
-			player_shoot = true;
-			shoot_locked = true;
+		else if (keyEvent == SDLK_SPACE) {
+			sim.shoot_down();
 		}
 	}
 
 	if (evt.type == SDL_KEYUP) {
 		auto keyEvent = evt.key.keysym.sym;
-		if (left_locked && (keyEvent == SDLK_a || keyEvent == SDLK_LEFT)) {
-			left_locked = false;
+		if (keyEvent == SDLK_a || keyEvent == SDLK_LEFT) {
+			sim.left_up();
 		}
-		else if (right_locked && (keyEvent == SDLK_d || keyEvent == SDLK_RIGHT)) {
-			right_locked = false;
+		else if (keyEvent == SDLK_d || keyEvent == SDLK_RIGHT) {
+			sim.right_up();
 		}
-		else if (shoot_locked && keyEvent == SDLK_SPACE) {
-			shoot_locked = false;
+		else if (keyEvent == SDLK_SPACE) {
+			sim.shoot_up();
 		}
 	}
 
 	if (evt.type == SDL_MOUSEBUTTONDOWN) {
-		auto keyEvent = evt.button.button;
-		if (!shoot_locked && keyEvent == SDL_BUTTON_LEFT && bullet_available > 0) {
-			player_shoot = true;
-			shoot_locked = true;
-		}		
+		if (evt.button.button == SDL_BUTTON_LEFT) {
+			sim.shoot_down();
+		}
 	}
 
 	if (evt.type == SDL_MOUSEBUTTONUP) {
-		auto keyEvent = evt.button.button;
-		if (shoot_locked && keyEvent == SDL_BUTTON_LEFT) {
-			shoot_locked = false;
+		if (evt.button.button == SDL_BUTTON_LEFT) {
+			sim.shoot_up();
 		}
 	}
 
@@ -173,224 +76,131 @@ bool NewMode::handle_event(SDL_Event const& evt, glm::uvec2 const& window_size)
 }
 
 void NewMode::update(float elapsed) {
-	if (game_freeze) return;
-
-	static std::mt19937 mt; //mersenne twister pseudo-random number generator
-
-	//---- player update ----
-	if (go_right) {
-		player.x += 2.0f;
-		go_right = false;
-	}
-	else if (go_left) {
-		player.x -= 2.0f;
-		go_left = false;
-	}
+	uint32_t old_score = sim.score;
+	bool was_frozen = sim.game_freeze;
 
-	player.x = std::max(player.x, -court_radius.x + player_radius.x);
-	player.x = std::min(player.x, court_radius.x - player_radius.x);
-
-	if (player_shoot ) {
-		player_shoot = false;
-		if (bullet_available > 0) {
-			bullet_available--;
-			bullet_used++;
-			bullets.emplace_back(player + glm::vec2(0.0f, 0.7f * player_radius.y + 2.0f * bullet_radius.y));
-			//std::cout << "Bullets available is" << bullet_available << "\n";
-		}
-	}
-		
-	//---- enemy update ----
-	assert(time_since_last_movement >= 0.0f);
-	time_since_last_movement += elapsed;
-	if (time_since_last_movement > movement_interval) {
-		time_since_last_movement -= movement_interval;
-		uint32_t remove_idx = UINT32_MAX;
-		for (uint32_t i = 0; i < enemy_positions.size(); i++) {
-			enemy_positions[i].y -= 0.5f;
-			if (enemy_positions[i].y < (player.y - player_radius.y * 2.0f)) {
-				remove_idx = i;
-				//std::cout << "there is one enemy below player" << "\n";
-			}
-		}
+	if (bot_playing) bot.act(sim);
 
-		if (remove_idx != UINT32_MAX) {
-			enemy_positions.erase(enemy_positions.begin(), enemy_positions.begin() + remove_idx + 1);
-			//std::cout << "erasing enemy" << "\n";
+	sim.update(elapsed);
 
-			score += remove_idx + 1;
-			if (bullet_available < 5) {
-				enemy_survived += remove_idx + 1;
-			}
-			row_survived++;
-			bullet_available = (int)enemy_survived / 5 - bullet_used + 1;
-			bullet_available = std::min(5, bullet_available);
-			//std::cout << "bullet_available: " << bullet_available << "\n";				
-			std::cout << "\r";
-			std::cout << "Score: " << score;
-			movement_interval = std::max(1.0f / (row_survived / 2.0f + 1.0f), 0.12f);
-		}
+	//frozen bullets don't move, so there is nothing to interpolate:
+	bullet_elapsed = (sim.game_freeze ? 0.0f : elapsed);
 
-		auto last_enemy = enemy_positions.back();
-		if (last_enemy.y < spawn_y - enemy_interval) {
-
-			int expected_bullet_num = bullet_available + (int) enemy_positions.size() / 5 - std::max((uint32_t)0, three_row_num) - 1;
-			//std::cout << "Expected number of bullet is: " << expected_bullet_num << "\n";
-
-			int max_enemy = 2;
-			if (expected_bullet_num > 0) {
-				if (three_in_a_row < bullet_available) {
-					max_enemy = 3;
-					three_in_a_row++;
-				}
-				else {
-					max_enemy = 2;
-					three_in_a_row = 0;
-				}
-			}
-			//std::cout << "max_enemy is: " << max_enemy << "\n";
-			add_enemies(enemy_positions, spawn_y, max_enemy);
-		}
-	}	
-
-	//---- bullet update ----
-	if (!bullets.empty()) {
-		for (uint32_t i = 0; i < bullets.size(); i++) {
-			bullets[i] += bullet_speed * elapsed;
-			if (bullets[i].y > court_radius.y) {
-				bullets.erase(bullets.begin() + i);
-				i--;
-			}
-		}
+	//the score is drawn on screen; the console only gets it if asked for, and then only every so often:
+	if (console_score && sim.score != old_score) {
+		//(each score line overwrites the last, so only the newest one needs to be written)
+		console_buffer = "\rScore: " + std::to_string(sim.score);
 	}
-
-	//---- collision handling ----
-	auto rect_a_vs_b = [this](glm::vec2 const& a_pos, glm::vec2 const& a_rad, glm::vec2 const& b_pos, glm::vec2 const& b_rad) {
-		//compute area of overlap:
-		glm::vec2 min = glm::max(a_pos - a_rad, b_pos - b_rad);
-		glm::vec2 max = glm::min(a_pos + a_rad, b_pos + b_rad);
-
-		//if no overlap, no collision:
-		if (min.x > max.x || min.y > max.y) return false;
-		return true;
-	};
-
-	//bullet vs enemy
-	if (!bullets.empty()) {
-		for (uint32_t i = 0; i < bullets.size(); i++) {
-			for (uint32_t j = 0; j < enemy_positions.size(); j++) {
-				if (bullets[i].x == enemy_positions[j].x
-					&& rect_a_vs_b(bullets[i], bullet_radius, enemy_positions[j], enemy_radius)) {
-					enemy_positions.erase(enemy_positions.begin() + j);
-					bullets.erase(bullets.begin() + i);
-					i--;
-					three_row_num--;
-					score += 2;
-					std::cout << "\r";
-					std::cout << "Score: " << score;
-					break;
-				}
-			}
-		}
+	if (console_score && sim.game_freeze && !was_frozen) {
+		console_buffer += "\nGame Over! Final score: " + std::to_string(sim.score) + "\n";
+		flush_console();
 	}
-
-	//enemy vs player
-	if (!enemy_positions.empty()) {
-		for (uint32_t i = 0; i < enemy_positions.size(); i++) {
-			if (enemy_positions[i].x == player.x
-				&& rect_a_vs_b(player, player_radius, enemy_positions[i], enemy_radius * 0.8f)) {
-				game_freeze = true;
-				std::cout << "\n" << "Game Over!" << std::endl;
-				return;
-			}
-		}
+	console_elapsed += elapsed;
+	if (console_elapsed >= console_interval) {
+		flush_console();
 	}
 }
 
-void NewMode::add_enemies(std::vector< glm::vec2 >& enemy_positions, float pos_y, int max_num)
-{
-	static std::mt19937 mt; //mersenne twister pseudo-random number generator
-
-	std::uniform_int_distribution<> num_dist(1, max_num);
-	int num = num_dist(mt);
-	//std::cout << "Number of enemy this row is: " << num << "\n";
-	std::uniform_int_distribution<> pos_dist(-1, 1);
-	int pos = pos_dist(mt);
-	//std::cout << "Randomed position is " << pos << "\n";
-
-	if (num == 3) {
-		enemy_positions.emplace_back(glm::vec2(-2.0f, pos_y));
-		enemy_positions.emplace_back(glm::vec2(0.0f, pos_y));
-		enemy_positions.emplace_back(glm::vec2(2.0f, pos_y));
-		three_row_num++;
-	}
-	else if (num == 2) {
-		for (int i = -1; i <= 1; i++) {
-			if (i == pos)
-				continue;
-			else {
-				enemy_positions.emplace_back(glm::vec2(i * 2.0f, pos_y));
-			}
-		}
-	}
-	else {
-		enemy_positions.emplace_back(glm::vec2(pos * 2.0f, pos_y));
-	}
-
+void NewMode::flush_console() {
+	console_elapsed = 0.0f;
+	if (console_buffer.empty()) return;
+	std::cout << console_buffer << std::flush;
+	console_buffer.clear();
 }
 
-void NewMode::draw_rectangle(std::vector< Vertex >& vertices, glm::vec2 const& center, glm::vec2 const& radius, glm::u8vec4 const& color) {
-	//draw rectangle as two CCW-oriented triangles:
-	vertices.emplace_back(glm::vec3(center.x - radius.x, center.y - radius.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
-	vertices.emplace_back(glm::vec3(center.x + radius.x, center.y - radius.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
-	vertices.emplace_back(glm::vec3(center.x + radius.x, center.y + radius.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
+std::string NewMode::status() const {
+	return "score " + std::to_string(sim.score) + (sim.game_freeze ? ", game over after " : ", still playing after ") + std::to_string(sim.ticks) + " ticks";
+}
 
-	vertices.emplace_back(glm::vec3(center.x - radius.x, center.y - radius.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
-	vertices.emplace_back(glm::vec3(center.x + radius.x, center.y + radius.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
-	vertices.emplace_back(glm::vec3(center.x - radius.x, center.y + radius.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
+void NewMode::draw_rectangle(std::vector< RectProgram::Instance >& rects, glm::vec2 const& center, glm::vec2 const& radius, glm::u8vec4 const& color) {
+	//(rect_program expands this into two CCW-oriented triangles)
+	rects.emplace_back(center, radius, color);
 }
 
-void NewMode::draw_tank(std::vector< Vertex >& vertices, glm::vec2 const& origin, glm::vec2 const& radius, const std::vector< glm::u8vec4 >& colors) {
-	assert(colors.size() == 3);
-	
+void NewMode::draw_tank(std::vector< RectProgram::Instance >& rects, glm::vec2 const& origin, glm::vec2 const& radius, std::array< glm::u8vec4, 3 > const& colors) {
 	glm::vec2 base_offset = glm::vec2(0.0f, -0.2f * radius.y);
 	glm::vec2 base_radius = glm::vec2(radius.x * 0.6f, radius.y * 0.7f);
-	draw_rectangle(vertices, origin + base_offset, base_radius, colors[0]);
+	draw_rectangle(rects, origin + base_offset, base_radius, colors[0]);
 
 	glm::vec2 turret_offset = glm::vec2(0.0f, -0.3f * radius.y);
 	glm::vec2 turret_radius = glm::vec2(radius.x * 0.3f, radius.y * 0.3f);
-	draw_rectangle(vertices, origin + turret_offset, turret_radius, colors[1]);
+	draw_rectangle(rects, origin + turret_offset, turret_radius, colors[1]);
 
 	glm::vec2 gun_offset = glm::vec2(0.0f, 0.4f * radius.y);
 	glm::vec2 gun_radius = glm::vec2(radius.x * 0.08f, radius.y * 0.5f);
-	draw_rectangle(vertices, origin + gun_offset, gun_radius, colors[2]);
+	draw_rectangle(rects, origin + gun_offset, gun_radius, colors[2]);
 }
 
-void NewMode::draw_bullet(std::vector< Vertex >& vertices, glm::vec2 const& origin, glm::vec2 const& radius, const std::vector< glm::u8vec4 >& colors) {
-	assert(colors.size() == 2);
-	
+void NewMode::draw_bullet(std::vector< Vertex >& vertices, std::vector< RectProgram::Instance >& rects, glm::vec2 const& origin, glm::vec2 const& radius, std::array< glm::u8vec4, 2 > const& colors) {
 	// top triangle
-	vertices.emplace_back(glm::vec3(origin.x - radius.x, origin.y + radius.y * 0.5f, 0.0f), colors[0], glm::vec2(0.5f, 0.5f));
-	vertices.emplace_back(glm::vec3(origin.x + radius.x, origin.y + radius.y * 0.5f, 0.0f), colors[0], glm::vec2(0.5f, 0.5f));
-	vertices.emplace_back(glm::vec3(origin.x, origin.y + radius.y, 0.0f), colors[0], glm::vec2(0.5f, 0.5f));
+	vertices.emplace_back(glm::vec3(origin.x - radius.x, origin.y + radius.y * 0.5f, 0.0f), colors[0]);
+	vertices.emplace_back(glm::vec3(origin.x + radius.x, origin.y + radius.y * 0.5f, 0.0f), colors[0]);
+	vertices.emplace_back(glm::vec3(origin.x, origin.y + radius.y, 0.0f), colors[0]);
 
 	glm::vec2 body_offset = glm::vec2(0.0f, -radius.y * 0.25f);
 	glm::vec2 body_radius = glm::vec2(radius.x, radius.y * 0.75f);
-	draw_rectangle(vertices, origin + body_offset, body_radius, colors[1]);
+	draw_rectangle(rects, origin + body_offset, body_radius, colors[1]);
 }
 
-void NewMode::draw(glm::uvec2 const& drawable_size) {
+//seven-segment digits: each segment is a rectangle in a 1x2 digit box centered on the origin,
+// and each digit lists its lit segments as bits (segment a is bit 0):
+//   -a-
+//  f   b
+//   -g-
+//  e   c
+//   -d-
+static const float SegmentThickness = 0.1f; //(radius)
+static const glm::vec2 SegmentCenters[7] = {
+	glm::vec2( 0.0f, 1.0f - SegmentThickness), glm::vec2( 0.5f - SegmentThickness, 0.5f), glm::vec2( 0.5f - SegmentThickness,-0.5f),
+	glm::vec2( 0.0f,-1.0f + SegmentThickness), glm::vec2(-0.5f + SegmentThickness,-0.5f), glm::vec2(-0.5f + SegmentThickness, 0.5f),
+	glm::vec2( 0.0f, 0.0f),
+};
+static const glm::vec2 SegmentRadii[7] = {
+	glm::vec2(0.5f, SegmentThickness), glm::vec2(SegmentThickness, 0.5f), glm::vec2(SegmentThickness, 0.5f),
+	glm::vec2(0.5f, SegmentThickness), glm::vec2(SegmentThickness, 0.5f), glm::vec2(SegmentThickness, 0.5f),
+	glm::vec2(0.5f, SegmentThickness),
+};
+static const uint8_t DigitSegments[10] = {
+	0x3f, 0x06, 0x5b, 0x4f, 0x66, 0x6d, 0x7d, 0x07, 0x7f, 0x6f,
+};
+
+void NewMode::draw_number(std::vector< RectProgram::Instance >& rects, glm::vec2 const& origin, float height, uint32_t value, glm::u8vec4 const& color) {
+	//digits, most significant first:
+	char digits[10];
+	uint32_t count = 0;
+	do {
+		digits[count++] = char(value % 10);
+		value /= 10;
+	} while (value);
+
+	float scale = 0.5f * height; //digit box is 2 units tall
+	float advance = 1.4f * scale;
+	for (uint32_t i = 0; i < count; ++i) {
+		glm::vec2 center = origin + glm::vec2(0.5f * scale + i * advance, 0.0f);
+		uint8_t lit = DigitSegments[uint32_t(digits[count - 1 - i])];
+		for (uint32_t s = 0; s < 7; ++s) {
+			if (lit & (1 << s)) {
+				draw_rectangle(rects, center + scale * SegmentCenters[s], scale * SegmentRadii[s], color);
+			}
+		}
+	}
+}
+
+//bullet (tip, body) and player tank (base, turret, gun) colors:
+static const std::array< glm::u8vec4, 2 > BulletColors = {{
+	glm::u8vec4(196, 202, 206, 255), glm::u8vec4(184, 115, 51, 255),
+}};
+static const std::array< glm::u8vec4, 3 > PlayerColors = {{
+	glm::u8vec4(109, 112, 79, 255), glm::u8vec4(150, 150, 150, 255), glm::u8vec4(150, 150, 150, 255),
+}};
+
+void NewMode::draw(glm::uvec2 const& drawable_size, float alpha) {
 
 	//some nice colors from the course web page:
 #define HEX_TO_U8VEC4( HX ) (glm::u8vec4( (HX >> 24) & 0xff, (HX >> 16) & 0xff, (HX >> 8) & 0xff, (HX) & 0xff ))
 	const glm::u8vec4 bg_color = HEX_TO_U8VEC4(0x193b59ff);
 	const glm::u8vec4 fg_color = HEX_TO_U8VEC4(0xf2d2b6ff);
 	const glm::u8vec4 shadow_color = HEX_TO_U8VEC4(0xf2ad94ff);
-	const std::vector< glm::u8vec4 > trail_colors = {
-		HEX_TO_U8VEC4(0xf2ad9488),
-		HEX_TO_U8VEC4(0xf2897288),
-		HEX_TO_U8VEC4(0xbacac088),
-	};
 #undef HEX_TO_U8VEC4
 
 	//other useful drawing constants:
@@ -398,80 +208,106 @@ void NewMode::draw(glm::uvec2 const& drawable_size) {
 	const float shadow_offset = 0.07f;
 	const float padding = 0.14f; //padding between outside of walls and edge of window
 
-	//---- compute vertices to draw ----
-
-	//vertices will be accumulated into this list and then uploaded+drawn at the end of this function:
-	std::vector< Vertex > vertices;
+	glm::vec2 score_radius = glm::vec2(0.2f, 0.2f);
 
-	//shadows for everything (except the trail):
+	//---- rebuild retained layers that are out of date ----
 
-	glm::vec2 s = glm::vec2(0.0f, -shadow_offset);
+	//court: shadows, then walls:
+	if (court_layer_radius != sim.court_radius) {
+		court_rects.clear();
 
-	draw_rectangle(vertices, glm::vec2(-court_radius.x - wall_radius, 0.0f) + s, glm::vec2(wall_radius, court_radius.y + 2.0f * wall_radius), shadow_color);
-	draw_rectangle(vertices, glm::vec2(court_radius.x + wall_radius, 0.0f) + s, glm::vec2(wall_radius, court_radius.y + 2.0f * wall_radius), shadow_color);
-	//draw_rectangle(vertices, glm::vec2(0.0f, -court_radius.y - wall_radius) + s, glm::vec2(court_radius.x, wall_radius), shadow_color);
-	//draw_rectangle(vertices, glm::vec2(0.0f, court_radius.y + wall_radius) + s, glm::vec2(court_radius.x, wall_radius), shadow_color);
+		glm::vec2 s = glm::vec2(0.0f, -shadow_offset);
 
-	//solid objects:
+		draw_rectangle(court_rects, glm::vec2(-sim.court_radius.x - wall_radius, 0.0f) + s, glm::vec2(wall_radius, sim.court_radius.y + 2.0f * wall_radius), shadow_color);
+		draw_rectangle(court_rects, glm::vec2(sim.court_radius.x + wall_radius, 0.0f) + s, glm::vec2(wall_radius, sim.court_radius.y + 2.0f * wall_radius), shadow_color);
+		//draw_rectangle(court_rects, glm::vec2(0.0f, -sim.court_radius.y - wall_radius) + s, glm::vec2(sim.court_radius.x, wall_radius), shadow_color);
+		//draw_rectangle(court_rects, glm::vec2(0.0f, sim.court_radius.y + wall_radius) + s, glm::vec2(sim.court_radius.x, wall_radius), shadow_color);
 
-	//walls:
-	draw_rectangle(vertices, glm::vec2(-court_radius.x - wall_radius, 0.0f), glm::vec2(wall_radius, court_radius.y + 2.0f * wall_radius), fg_color);
-	draw_rectangle(vertices, glm::vec2(court_radius.x + wall_radius, 0.0f), glm::vec2(wall_radius, court_radius.y + 2.0f * wall_radius), fg_color);
-	//draw_rectangle(vertices, glm::vec2(0.0f, -court_radius.y - wall_radius), glm::vec2(court_radius.x, wall_radius), fg_color);
-	//draw_rectangle(vertices, glm::vec2(0.0f, court_radius.y + wall_radius), glm::vec2(court_radius.x, wall_radius), fg_color);
+		draw_rectangle(court_rects, glm::vec2(-sim.court_radius.x - wall_radius, 0.0f), glm::vec2(wall_radius, sim.court_radius.y + 2.0f * wall_radius), fg_color);
+		draw_rectangle(court_rects, glm::vec2(sim.court_radius.x + wall_radius, 0.0f), glm::vec2(wall_radius, sim.court_radius.y + 2.0f * wall_radius), fg_color);
+		//draw_rectangle(court_rects, glm::vec2(0.0f, -sim.court_radius.y - wall_radius), glm::vec2(sim.court_radius.x, wall_radius), fg_color);
+		//draw_rectangle(court_rects, glm::vec2(0.0f, sim.court_radius.y + wall_radius), glm::vec2(sim.court_radius.x, wall_radius), fg_color);
 
-	// enemies
-	for (uint32_t i = 0; i < enemy_positions.size(); i++)
-	{
-		draw_rectangle(vertices, enemy_positions[i], enemy_radius, fg_color);
+		court_layer.upload(court_rects.data(), court_rects.size() * sizeof(court_rects[0]));
+		court_layer_radius = sim.court_radius;
 	}
 
-	// bullets
-	std::vector< glm::u8vec4 > bullet_color;
-	bullet_color.emplace_back(glm::u8vec4(196.0f, 202.0f, 206.0f, 255.0f));
-	bullet_color.emplace_back(glm::u8vec4(184.0f, 115.0f, 51.0f, 255.0f));
-	for (uint32_t i = 0; i < bullets.size(); i++) {
-		//draw_rectangle(vertices, bullets[i], bullet_radius, fg_color);
-		draw_bullet(vertices, bullets[i], bullet_radius, bullet_color);
-	}
+	//HUD: bullet icons and score (above the top left corner of the court):
+	if (hud_bullets != sim.bullet_available || hud_score != sim.score) {
+		hud_rects.clear();
+		hud_vertices.clear();
 
-	if (bullet_available > 0) {
-		for (int32_t i = 0; i < bullet_available; i++) {
+		for (int32_t i = 0; i < sim.bullet_available; i++) {
 			glm::vec2 icon_pos = bullet_icon_starting + glm::vec2((i % 5) * -0.8f, 0.0f);
-			draw_bullet(vertices, icon_pos, bullet_icon_radius, bullet_color);
+			draw_bullet(hud_vertices, hud_rects, icon_pos, bullet_icon_radius, BulletColors);
 		}
+
+		draw_number(hud_rects, glm::vec2(-sim.court_radius.x, sim.court_radius.y + 2.0f * wall_radius + 1.5f * score_radius.y), 2.0f * score_radius.y, sim.score, fg_color);
+
+		hud_rects_layer.upload(hud_rects.data(), hud_rects.size() * sizeof(hud_rects[0]));
+		hud_vertices_layer.upload(hud_vertices.data(), hud_vertices.size() * sizeof(hud_vertices[0]));
+		hud_bullets = sim.bullet_available;
+		hud_score = sim.score;
 	}
-	
 
-	//player
-	std::vector< glm::u8vec4 > player_color;
-	player_color.emplace_back(glm::u8vec4(109.0f, 112.0f, 79.0f, 255.0f));
-	player_color.emplace_back(glm::u8vec4(150.0f, 150.0f, 150.0f, 255.0f));
-	player_color.emplace_back(glm::u8vec4(150.0f, 150.0f, 150.0f, 255.0f));
+	//---- compute rectangles and vertices for things that move ----
+
+	//rectangles and vertices will be accumulated into the arenas and then submitted to the renderer:
+	rects.clear();
+	vertices.clear();
+	size_t rects_capacity = rects.capacity();
+	size_t vertices_capacity = vertices.capacity();
+	Renderer2D &renderer = *Renderer2D::current;
+	size_t renderer_bytes = renderer.arena_bytes();
+	uint64_t allocations = allocation_count();
+	(void)allocations; //(only read by the assert below, which NDEBUG builds drop)
 
-	draw_tank(vertices, player, player_radius, player_color);
+	// enemies
+	for (uint32_t r = sim.rows.head; r != sim.rows.tail; r++) {
+		TankSim::EnemyRow const &row = sim.rows[r];
+		float y = sim.row_y(row);
+		for (uint64_t lanes = row.lanes; lanes; lanes &= lanes - 1) {
+			uint32_t lane = lowest_set_bit(lanes);
+			draw_rectangle(rects, glm::vec2(sim.lane_x(lane), y), sim.enemy_radius, fg_color);
+		}
+	}
 
-	//scores:
-	glm::vec2 score_radius = glm::vec2(0.1f, 0.1f);
-	//for (uint32_t i = 0; i < left_score; ++i) {
-	//	draw_rectangle(vertices, glm::vec2(-court_radius.x + (2.0f + 3.0f * i) * score_radius.x, court_radius.y + 2.0f * wall_radius + 2.0f * score_radius.y), score_radius, fg_color);
-	//}
-	//for (uint32_t i = 0; i < right_score; ++i) {
-	//	draw_rectangle(vertices, glm::vec2(court_radius.x - (2.0f + 3.0f * i) * score_radius.x, court_radius.y + 2.0f * wall_radius + 2.0f * score_radius.y), score_radius, fg_color);
-	//}
+	// bullets
+	//bullets move in a straight line, so step back along their path by the not-yet-simulated part of the last update:
+	glm::vec2 bullet_lag = sim.bullet_speed * ((alpha - 1.0f) * bullet_elapsed);
+	for (uint32_t i = 0; i < sim.bullets.size(); i++) {
+		//draw_rectangle(rects, sim.bullets.position[i], sim.bullets.radius[i], fg_color);
+		draw_bullet(vertices, rects, sim.bullets.position[i] + bullet_lag, sim.bullets.radius[i], BulletColors);
+	}
 
+	//player
+	draw_tank(rects, sim.player, sim.player_radius, PlayerColors);
+
+	//submit everything (bullet tips are triangles; the rest are rectangles):
+	renderer.retained_rects(CourtLayer, court_layer, 0, uint32_t(court_rects.size()));
+	renderer.rects(MovingLayer, rects.data(), uint32_t(rects.size()));
+	renderer.triangles(MovingLayer, vertices.data(), uint32_t(vertices.size()));
+	renderer.retained_rects(HudLayer, hud_rects_layer, 0, uint32_t(hud_rects.size()));
+	renderer.retained_triangles< Vertex >(HudLayer, hud_vertices_layer, 0, uint32_t(hud_vertices.size()));
+
+	//once the arenas are big enough, building a frame shouldn't touch the heap:
+	if (rects.capacity() != rects_capacity || vertices.capacity() != vertices_capacity || renderer.arena_bytes() != renderer_bytes) {
+		vertex_arena_growths += 1;
+	} else {
+		assert(allocation_count() == allocations);
+	}
 
 
 	//------ compute court-to-window transform ------
 
 	//compute area that should be visible:
 	glm::vec2 scene_min = glm::vec2(
-		-court_radius.x - 2.0f * wall_radius - padding,
-		-court_radius.y - 2.0f * wall_radius - padding
+		-sim.court_radius.x - 2.0f * wall_radius - padding,
+		-sim.court_radius.y - 2.0f * wall_radius - padding
 	);
 	glm::vec2 scene_max = glm::vec2(
-		court_radius.x + 2.0f * wall_radius + padding,
-		court_radius.y + 2.0f * wall_radius + 3.0f * score_radius.y + padding
+		sim.court_radius.x + 2.0f * wall_radius + padding,
+		sim.court_radius.y + 2.0f * wall_radius + 3.0f * score_radius.y + padding
 	);
 
 	//compute window aspect ratio:
@@ -509,43 +345,8 @@ void NewMode::draw(glm::uvec2 const& drawable_size) {
 	glClearColor(bg_color.r / 255.0f, bg_color.g / 255.0f, bg_color.b / 255.0f, bg_color.a / 255.0f);
 	glClear(GL_COLOR_BUFFER_BIT);
 
-	//use alpha blending:
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	//don't use the depth test:
-	glDisable(GL_DEPTH_TEST);
-
-	//upload vertices to vertex_buffer:
-	glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer); //set vertex_buffer as current
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(vertices[0]), vertices.data(), GL_STREAM_DRAW); //upload vertices array
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-	//set color_texture_program as current program:
-	glUseProgram(color_texture_program.program);
-
-	//upload OBJECT_TO_CLIP to the proper uniform location:
-	glUniformMatrix4fv(color_texture_program.OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(court_to_clip));
-
-	//use the mapping vertex_buffer_for_color_texture_program to fetch vertex data:
-	glBindVertexArray(vertex_buffer_for_color_texture_program);
-
-	//bind the solid white texture to location zero so things will be drawn just with their colors:
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, white_tex);
-
-	//run the OpenGL pipeline:
-	glDrawArrays(GL_TRIANGLES, 0, GLsizei(vertices.size()));
-
-	//unbind the solid white texture:
-	glBindTexture(GL_TEXTURE_2D, 0);
-
-	//reset vertex array to none:
-	glBindVertexArray(0);
-
-	//reset current program to none:
-	glUseProgram(0);
-
-
-	GL_ERRORS(); //PARANOIA: print errors just in case we did something wrong.
+	renderer.flush(court_to_clip);
 
+	//draw() ends each frame, so the bot's search gets a fresh time budget for the next frame's updates:
+	if (bot_playing) bot.begin_frame();
 }
\ No newline at end of file
@@ -1,4 +1,7 @@
-#include "ColorTextureProgram.hpp"
+#include "Renderer2D.hpp"
+#include "TankSim.hpp"
+#include "TankBot.hpp"
+#include "RowGenerator.hpp"
 
 #include "Mode.hpp"
 #include "GL.hpp"
@@ -6,96 +9,96 @@
 #include <glm/glm.hpp>
 
 #include <vector>
+#include <array>
 #include <deque>
+#include <memory>
 
 /*
  * PongMode is a game mode that implements a single-player game of Pong.
  */
 
 struct NewMode : Mode {
-	NewMode();
+	//rows_ahead > 0 has a RowGenerator thread make enemy rows up to that many ahead:
+	NewMode(uint32_t seed = 0, uint32_t rows_ahead = 0);
 	virtual ~NewMode();
 
 	//functions called by main loop:
 	virtual bool handle_event(SDL_Event const&, glm::uvec2 const& window_size) override;
 	virtual void update(float elapsed) override;
-	virtual void draw(glm::uvec2 const& drawable_size) override;
+	virtual void draw(glm::uvec2 const& drawable_size, float alpha) override;
+	virtual std::string status() const override;
 
 	//----- game state -----
-	// enemy
-	float time_since_last_movement = 0.0f;
-	float movement_interval = 1.0f;
-	float enemy_interval = 3.5f;
-	float spawn_y;
-	std::vector < glm::vec2 > enemy_positions;
-
-	glm::vec2 court_radius = glm::vec2(3.0f, 7.0f);
-	glm::vec2 bullet_radius = glm::vec2(0.2f, 0.4f);
-	glm::vec2 enemy_radius = glm::vec2(0.6f, 0.6f);
-	glm::vec2 player_radius = glm::vec2(1.0f, 1.0f);
-
-
-	// bullets
-	uint32_t three_row_num = 0;
-	int32_t three_in_a_row = 0;
-	int32_t bullet_available = 1;
-	uint32_t bullet_used = 0;
-	std::vector < glm::vec2 > bullets;
-	glm::vec2 bullet_speed = glm::vec2(0.0f, 5.0f);
-
-	glm::vec2 bullet_icon_radius = glm::vec2(0.3f, 0.8f);
-	glm::vec2 bullet_icon_starting = glm::vec2(court_radius.x + 3.8f, -court_radius.y + 1.0f);
-
-	// player
-	glm::vec2 player = glm::vec2(0.0f, -court_radius.y + 1.0f);
-
-	uint32_t score = 0;
-	uint32_t enemy_survived = 0;
-	uint32_t row_survived = 0;
+	//(rules and state live in TankSim so they can also run headless)
+	std::unique_ptr< RowGenerator > row_generator; //(declared before sim, which uses it)
+	TankSim sim;
 
+	//length of the last update, used to interpolate bullets in draw():
+	float bullet_elapsed = 0.0f;
 
-	bool go_right = false;
-	bool right_locked = false;
-	bool go_left = false;
-	bool left_locked = false;
-	bool player_shoot = false;
-	bool shoot_locked = false;
+	//when bot_playing is set, the bot presses the keys (and the player's are ignored):
+	bool bot_playing = false;
+	TankBot bot;
 
-	bool game_freeze = false;
-
-	//----- pretty gradient trails -----
+	glm::vec2 bullet_icon_radius = glm::vec2(0.3f, 0.8f);
+	glm::vec2 bullet_icon_starting = glm::vec2(sim.court_radius.x + 3.8f, -sim.court_radius.y + 1.0f);
 
 	//----- opengl assets / helpers ------
 
-	//draw functions will work on vectors of vertices, defined as follows:
-	struct Vertex {
-		Vertex(glm::vec3 const& Position_, glm::u8vec4 const& Color_, glm::vec2 const& TexCoord_) :
-			Position(Position_), Color(Color_), TexCoord(TexCoord_) { }
-		glm::vec3 Position;
-		glm::u8vec4 Color;
-		glm::vec2 TexCoord;
+	//everything is drawn through Renderer2D, in these layers (back to front):
+	enum Layer : uint8_t {
+		CourtLayer,
+		MovingLayer, //(enemies, bullets, player)
+		HudLayer,
 	};
-	static_assert(sizeof(Vertex) == 4 * 3 + 1 * 4 + 4 * 2, "NewMode::Vertex should be packed");
 
-	//Shader program that draws transformed, vertices tinted with vertex colors:
-	ColorTextureProgram color_texture_program;
+	//draw functions will work on vectors of vertices; everything here is solid-colored,
+	// so they are the color-only variant (no texture coordinate, drawn without a texture):
+	typedef DrawVertex< false > Vertex;
+
+	//rectangles are drawn as RectProgram instances, everything else (bullet tips) as triangles of Vertex.
+
+	//vertex and rectangle arenas for things that move: draw() clears and refills these every frame, so they keep their
+	// high-water capacity and (once the frame stops growing) don't allocate:
+	std::vector< Vertex > vertices;
+	std::vector< RectProgram::Instance > rects;
+	uint32_t vertex_arena_growths = 0; //frames on which an arena (this mode's or the renderer's) had to grow
 
-	//Buffer used to hold vertex data during drawing:
-	GLuint vertex_buffer = 0;
+	//----- retained layers -----
+	//things that rarely change are kept in retained buffers and only rebuilt when out of date:
 
-	//Vertex Array Object that maps buffer locations to color_texture_program attribute locations:
-	GLuint vertex_buffer_for_color_texture_program = 0;
+	//the court (wall shadows, then walls), rebuilt if the court size changes:
+	std::vector< RectProgram::Instance > court_rects;
+	RetainedBuffer court_layer{GL_STATIC_DRAW};
+	glm::vec2 court_layer_radius = glm::vec2(0.0f); //court size court_layer was built for
 
-	//Solid white texture:
-	GLuint white_tex = 0;
+	//the HUD (bullet icons and score), rebuilt when the bullets available or the score change:
+	std::vector< RectProgram::Instance > hud_rects;
+	std::vector< Vertex > hud_vertices; //(bullet icon tips)
+	RetainedBuffer hud_rects_layer{GL_DYNAMIC_DRAW};
+	RetainedBuffer hud_vertices_layer{GL_DYNAMIC_DRAW};
+	int32_t hud_bullets = -1; //bullets available the HUD shows
+	uint32_t hud_score = ~0U; //score the HUD shows
 
 	//matrix that maps from clip coordinates to court-space coordinates:
 	glm::mat3x2 clip_to_court = glm::mat3x2(1.0f);
 	// computed in draw() as the inverse of OBJECT_TO_CLIP
 	// (stored here so that the mouse handling code can use it to position the paddle)
 
-	void add_enemies(std::vector< glm::vec2 >& enemy_positions, float pos_y, int max_num);
-	void draw_rectangle(std::vector< Vertex >& vertices, glm::vec2 const& center, glm::vec2 const& radius, glm::u8vec4 const& color);
-	void draw_tank(std::vector< Vertex >& vertices, glm::vec2 const& origin, glm::vec2 const& radius, const std::vector< glm::u8vec4 >& colors);
-	void draw_bullet(std::vector< Vertex >& vertices, glm::vec2 const& origin, glm::vec2 const& radius, const std::vector< glm::u8vec4 >& colors);
+	//----- score display -----
+
+	//the score is drawn as seven-segment digits above the court (in the HUD layer);
+	//score and game over can also be printed to the console (off by default);
+	// output is collected in console_buffer and written at most every console_interval seconds:
+	bool console_score = false;
+	float console_interval = 1.0f;
+	float console_elapsed = 0.0f;
+	std::string console_buffer;
+	void flush_console();
+
+	void draw_rectangle(std::vector< RectProgram::Instance >& rects, glm::vec2 const& center, glm::vec2 const& radius, glm::u8vec4 const& color);
+	void draw_tank(std::vector< RectProgram::Instance >& rects, glm::vec2 const& origin, glm::vec2 const& radius, std::array< glm::u8vec4, 3 > const& colors);
+	void draw_bullet(std::vector< Vertex >& vertices, std::vector< RectProgram::Instance >& rects, glm::vec2 const& origin, glm::vec2 const& radius, std::array< glm::u8vec4, 2 > const& colors);
+	//draws 'value' as seven-segment digits 'height' tall, starting with the left edge of the first digit at 'origin':
+	void draw_number(std::vector< RectProgram::Instance >& rects, glm::vec2 const& origin, float height, uint32_t value, glm::u8vec4 const& color);
 };
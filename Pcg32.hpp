@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+
+/*
+ * Pcg32 is a small, fast pseudo-random number generator (PCG-XSH-RR, see
+ *  https://www.pcg-random.org/). Its whole state is 16 bytes, versus about
+ *  5KB for std::mt19937, and it can be used anywhere the standard <random>
+ *  distributions expect a generator.
+ */
+
+struct Pcg32 {
+	typedef uint32_t result_type;
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return 0xffffffffu; }
+
+	explicit Pcg32(uint64_t seed_ = 0, uint64_t stream = 0x14057b7ef767814fULL) {
+		seed(seed_, stream);
+	}
+
+	void seed(uint64_t seed_, uint64_t stream = 0x14057b7ef767814fULL) {
+		state = 0;
+		inc = (stream << 1) | 1;
+		(*this)();
+		state += seed_;
+		(*this)();
+	}
+
+	result_type operator()() {
+		uint64_t old = state;
+		state = old * 6364136223846793005ULL + inc;
+		uint32_t xorshifted = uint32_t(((old >> 18) ^ old) >> 27);
+		uint32_t rot = uint32_t(old >> 59);
+		return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+	}
+
+	uint64_t state;
+	uint64_t inc; //(always odd)
+};
+
+//The generator that game modes and simulations own.
+//Build with GAME_RNG_MT19937 defined to use std::mt19937 instead.
+#ifdef GAME_RNG_MT19937
+typedef std::mt19937 GameRng;
+#else
+typedef Pcg32 GameRng;
+#endif
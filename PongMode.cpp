@@ -1,120 +1,30 @@
 #include "PongMode.hpp"
 
-//for the GL_ERRORS() macro:
-#include "gl_errors.hpp"
+#include <iostream>
 
-//for glm::value_ptr() :
-#include <glm/gtc/type_ptr.hpp>
+//for checking that draw() doesn't allocate:
+#include "allocation_count.hpp"
 
-#include <random>
+#include <cassert>
 
-PongMode::PongMode() {
+PongMode::PongMode(uint32_t seed) : sim(seed) {
 
-	//set up trail as if ball has been here for 'forever':
-	ball_trail.clear();
-	ball_trail.emplace_back(ball, trail_length);
-	ball_trail.emplace_back(ball, 0.0f);
-
-	
-	//----- allocate OpenGL resources -----
-	{ //vertex buffer:
-		glGenBuffers(1, &vertex_buffer);
-		//for now, buffer will be un-filled.
-
-		GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
-	}
-
-	{ //vertex array mapping buffer for color_texture_program:
-		//ask OpenGL to fill vertex_buffer_for_color_texture_program with the name of an unused vertex array object:
-		glGenVertexArrays(1, &vertex_buffer_for_color_texture_program);
-
-		//set vertex_buffer_for_color_texture_program as the current vertex array object:
-		glBindVertexArray(vertex_buffer_for_color_texture_program);
-
-		//set vertex_buffer as the source of glVertexAttribPointer() commands:
-		glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
-
-		//set up the vertex array object to describe arrays of PongMode::Vertex:
-		glVertexAttribPointer(
-			color_texture_program.Position_vec4, //attribute
-			3, //size
-			GL_FLOAT, //type
-			GL_FALSE, //normalized
-			sizeof(Vertex), //stride
-			(GLbyte *)0 + 0 //offset
-		);
-		glEnableVertexAttribArray(color_texture_program.Position_vec4);
-		//[Note that it is okay to bind a vec3 input to a vec4 attribute -- the w component will be filled with 1.0 automatically]
-
-		glVertexAttribPointer(
-			color_texture_program.Color_vec4, //attribute
-			4, //size
-			GL_UNSIGNED_BYTE, //type
-			GL_TRUE, //normalized
-			sizeof(Vertex), //stride
-			(GLbyte *)0 + 4*3 //offset
-		);
-		glEnableVertexAttribArray(color_texture_program.Color_vec4);
-
-		glVertexAttribPointer(
-			color_texture_program.TexCoord_vec2, //attribute
-			2, //size
-			GL_FLOAT, //type
-			GL_FALSE, //normalized
-			sizeof(Vertex), //stride
-			(GLbyte *)0 + 4*3 + 4*1 //offset
-		);
-		glEnableVertexAttribArray(color_texture_program.TexCoord_vec2);
-
-		//done referring to vertex_buffer, so unbind it:
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	//room for the whole trail at 1000 updates per second, plus bounces:
+	uint32_t trail_capacity = 1;
+	while (trail_capacity < 2 * uint32_t(trail_length * 1000.0f)) trail_capacity *= 2;
+	ball_trail.assign(trail_capacity, TrailPoint{glm::vec2(0.0f), 0.0});
+	trail_mask = trail_capacity - 1;
 
-		//done setting up vertex array object, so unbind it:
-		glBindVertexArray(0);
-
-		GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
-	}
-
-	{ //solid white texture:
-		//ask OpenGL to fill white_tex with the name of an unused texture object:
-		glGenTextures(1, &white_tex);
-
-		//bind that texture object as a GL_TEXTURE_2D-type texture:
-		glBindTexture(GL_TEXTURE_2D, white_tex);
-
-		//upload a 1x1 image of solid white to the texture:
-		glm::uvec2 size = glm::uvec2(1,1);
-		std::vector< glm::u8vec4 > data(size.x*size.y, glm::u8vec4(0xff, 0xff, 0xff, 0xff));
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size.x, size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, data.data());
-
-		//set filtering and wrapping parameters:
-		//(it's a bit silly to mipmap a 1x1 texture, but I'm doing it because you may want to use this code to load different sizes of texture)
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-		//since texture uses a mipmap and we haven't uploaded one, instruct opengl to make one for us:
-		glGenerateMipmap(GL_TEXTURE_2D);
-
-		//Okay, texture uploaded, can unbind it:
-		glBindTexture(GL_TEXTURE_2D, 0);
-
-		GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
-	}
+	//set up trail as if ball has been here for 'forever':
+	glm::vec2 const &ball_at = sim.entities.position[sim.entities.at(sim.ball)];
+	add_trail_point(ball_at, -trail_length);
+	add_trail_point(ball_at, 0.0);
 }
 
 PongMode::~PongMode() {
-
-	//----- free OpenGL resources -----
-	glDeleteBuffers(1, &vertex_buffer);
-	vertex_buffer = 0;
-
-	glDeleteVertexArrays(1, &vertex_buffer_for_color_texture_program);
-	vertex_buffer_for_color_texture_program = 0;
-
-	glDeleteTextures(1, &white_tex);
-	white_tex = 0;
+	if (court_layer.rebuilds) {
+		std::cout << "Retained layers: court " << court_layer.report() << "; score " << score_layer.report() << "." << std::endl;
+	}
 }
 
 bool PongMode::handle_event(SDL_Event const &evt, glm::uvec2 const &window_size) {
@@ -125,7 +35,7 @@ bool PongMode::handle_event(SDL_Event const &evt, glm::uvec2 const &window_size)
 			(evt.motion.x + 0.5f) / window_size.x * 2.0f - 1.0f,
 			(evt.motion.y + 0.5f) / window_size.y *-2.0f + 1.0f
 		);
-		left_paddle.y = (clip_to_court * glm::vec3(clip_mouse, 1.0f)).y;
+		sim.set_left_paddle((clip_to_court * glm::vec3(clip_mouse, 1.0f)).y);
 	}
 
 	return false;
@@ -133,134 +43,51 @@ bool PongMode::handle_event(SDL_Event const &evt, glm::uvec2 const &window_size)
 
 void PongMode::update(float elapsed) {
 
-	static std::mt19937 mt; //mersenne twister pseudo-random number generator
-
-	//----- paddle update -----
-
-	{ //right player ai:
-		ai_offset_update -= elapsed;
-		if (ai_offset_update < elapsed) {
-			//update again in [0.5,1.0) seconds:
-			ai_offset_update = (mt() / float(mt.max())) * 0.5f + 0.5f;
-			ai_offset = (mt() / float(mt.max())) * 2.5f - 1.25f;
-		}
-		if (right_paddle.y < ball.y + ai_offset) {
-			right_paddle.y = std::min(ball.y + ai_offset, right_paddle.y + 2.0f * elapsed);
-		} else {
-			right_paddle.y = std::max(ball.y + ai_offset, right_paddle.y - 2.0f * elapsed);
-		}
-	}
-
-	//clamp paddles to court:
-	right_paddle.y = std::max(right_paddle.y, -court_radius.y + paddle_radius.y);
-	right_paddle.y = std::min(right_paddle.y,  court_radius.y - paddle_radius.y);
-
-	left_paddle.y = std::max(left_paddle.y, -court_radius.y + paddle_radius.y);
-	left_paddle.y = std::min(left_paddle.y,  court_radius.y - paddle_radius.y);
-
-	//----- ball update -----
+	sim.update(elapsed);
+	glm::vec2 const &ball_at = sim.entities.position[sim.entities.at(sim.ball)];
 
-	//speed of ball doubles every four points:
-	float speed_multiplier = 4.0f * std::pow(2.0f, (left_score + right_score) / 4.0f);
-
-	//velocity cap, though (otherwise ball can pass through paddles):
-	speed_multiplier = std::min(speed_multiplier, 10.0f);
-
-	ball += elapsed * speed_multiplier * ball_velocity;
-
-	//---- collision handling ----
-
-	//paddles:
-	auto paddle_vs_ball = [this](glm::vec2 const &paddle) {
-		//compute area of overlap:
-		glm::vec2 min = glm::max(paddle - paddle_radius, ball - ball_radius);
-		glm::vec2 max = glm::min(paddle + paddle_radius, ball + ball_radius);
-
-		//if no overlap, no collision:
-		if (min.x > max.x || min.y > max.y) return;
+	//----- gradient trails -----
 
-		if (max.x - min.x > max.y - min.y) {
-			//wider overlap in x => bounce in y direction:
-			if (ball.y > paddle.y) {
-				ball.y = paddle.y + paddle_radius.y + ball_radius.y;
-				ball_velocity.y = std::abs(ball_velocity.y);
-			} else {
-				ball.y = paddle.y - paddle_radius.y - ball_radius.y;
-				ball_velocity.y = -std::abs(ball_velocity.y);
-			}
-		} else {
-			//wider overlap in y => bounce in x direction:
-			if (ball.x > paddle.x) {
-				ball.x = paddle.x + paddle_radius.x + ball_radius.x;
-				ball_velocity.x = std::abs(ball_velocity.x);
-			} else {
-				ball.x = paddle.x - paddle_radius.x - ball_radius.x;
-				ball_velocity.x = -std::abs(ball_velocity.x);
-			}
-			//warp y velocity based on offset from paddle center:
-			float vel = (ball.y - paddle.y) / (paddle_radius.y + ball_radius.y);
-			ball_velocity.y = glm::mix(ball_velocity.y, vel, 0.75f);
-		}
-	};
-	paddle_vs_ball(left_paddle);
-	paddle_vs_ball(right_paddle);
-
-	//court walls:
-	if (ball.y > court_radius.y - ball_radius.y) {
-		ball.y = court_radius.y - ball_radius.y;
-		if (ball_velocity.y > 0.0f) {
-			ball_velocity.y = -ball_velocity.y;
-		}
-	}
-	if (ball.y < -court_radius.y + ball_radius.y) {
-		ball.y = -court_radius.y + ball_radius.y;
-		if (ball_velocity.y < 0.0f) {
-			ball_velocity.y = -ball_velocity.y;
-		}
+	//store this update's bounces and fresh location at back of ball trail:
+	for (glm::vec3 const &bounce : sim.bounce_points) {
+		add_trail_point(glm::vec2(bounce), trail_time + bounce.z);
 	}
+	trail_time += elapsed;
+	add_trail_point(ball_at, trail_time);
 
-	if (ball.x > court_radius.x - ball_radius.x) {
-		ball.x = court_radius.x - ball_radius.x;
-		if (ball_velocity.x > 0.0f) {
-			ball_velocity.x = -ball_velocity.x;
-			left_score += 1;
-		}
-	}
-	if (ball.x < -court_radius.x + ball_radius.x) {
-		ball.x = -court_radius.x + ball_radius.x;
-		if (ball_velocity.x < 0.0f) {
-			ball_velocity.x = -ball_velocity.x;
-			right_score += 1;
-		}
+	//trim any too-old locations from front of trail:
+	//NOTE: since trail drawing interpolates between points, only removes front element if second-to-front element is too old:
+	while (trail_tail - trail_head >= 2 && ball_trail[(trail_head + 1) & trail_mask].time < trail_time - trail_length) {
+		trail_head += 1;
 	}
+}
 
-	//----- gradient trails -----
-
-	//age up all locations in ball trail:
-	for (auto &t : ball_trail) {
-		t.z += elapsed;
-	}
-	//store fresh location at back of ball trail:
-	ball_trail.emplace_back(ball, 0.0f);
+void PongMode::add_trail_point(glm::vec2 const &at, double time) {
+	if (trail_tail - trail_head > trail_mask) trail_head += 1;
+	ball_trail[trail_tail & trail_mask] = TrailPoint{at, time};
+	trail_tail += 1;
+}
 
-	//trim any too-old locations from back of trail:
-	//NOTE: since trail drawing interpolates between points, only removes back element if second-to-back element is too old:
-	while (ball_trail.size() >= 2 && ball_trail[1].z > trail_length) {
-		ball_trail.pop_front();
-	}
+std::string PongMode::status() const {
+	glm::vec2 const &ball_at = sim.entities.position[sim.entities.at(sim.ball)];
+	return "score " + std::to_string(sim.left_score) + " to " + std::to_string(sim.right_score)
+		+ ", ball at (" + std::to_string(ball_at.x) + ", " + std::to_string(ball_at.y) + ")";
 }
 
-void PongMode::draw(glm::uvec2 const &drawable_size) {
+//colors the ball's trail fades through, newest to oldest:
+static const glm::u8vec4 TrailColors[3] = {
+	glm::u8vec4(0xf2, 0xad, 0x94, 0x88),
+	glm::u8vec4(0xf2, 0x89, 0x72, 0x88),
+	glm::u8vec4(0xba, 0xca, 0xc0, 0x88),
+};
+static const int32_t TrailColorCount = int32_t(sizeof(TrailColors) / sizeof(TrailColors[0]));
+
+void PongMode::draw(glm::uvec2 const &drawable_size, float alpha) {
 	//some nice colors from the course web page:
 	#define HEX_TO_U8VEC4( HX ) (glm::u8vec4( (HX >> 24) & 0xff, (HX >> 16) & 0xff, (HX >> 8) & 0xff, (HX) & 0xff ))
 	const glm::u8vec4 bg_color = HEX_TO_U8VEC4(0x193b59ff);
 	const glm::u8vec4 fg_color = HEX_TO_U8VEC4(0xf2d2b6ff);
 	const glm::u8vec4 shadow_color = HEX_TO_U8VEC4(0xf2ad94ff);
-	const std::vector< glm::u8vec4 > trail_colors = {
-		HEX_TO_U8VEC4(0xf2ad9488),
-		HEX_TO_U8VEC4(0xf2897288),
-		HEX_TO_U8VEC4(0xbacac088),
-	};
 	#undef HEX_TO_U8VEC4
 
 	//other useful drawing constants:
@@ -268,57 +95,91 @@ void PongMode::draw(glm::uvec2 const &drawable_size) {
 	const float shadow_offset = 0.07f;
 	const float padding = 0.14f; //padding between outside of walls and edge of window
 
-	//---- compute vertices to draw ----
+	glm::vec2 s = glm::vec2(0.0f,-shadow_offset);
+	glm::vec2 score_radius = glm::vec2(0.1f, 0.1f);
 
-	//vertices will be accumulated into this list and then uploaded+drawn at the end of this function:
-	std::vector< Vertex > vertices;
+	//---- rebuild retained layers that are out of date ----
+
+	//court walls and their shadows (shadows first, so they can be drawn under everything else):
+	if (court_layer_radius != sim.court_radius) {
+		court_rects.clear();
+		auto draw_walls = [&](glm::vec2 const &o, glm::u8vec4 const &color) {
+			court_rects.emplace_back(glm::vec2(-sim.court_radius.x-wall_radius, 0.0f)+o, glm::vec2(wall_radius, sim.court_radius.y + 2.0f * wall_radius), color);
+			court_rects.emplace_back(glm::vec2( sim.court_radius.x+wall_radius, 0.0f)+o, glm::vec2(wall_radius, sim.court_radius.y + 2.0f * wall_radius), color);
+			court_rects.emplace_back(glm::vec2( 0.0f,-sim.court_radius.y-wall_radius)+o, glm::vec2(sim.court_radius.x, wall_radius), color);
+			court_rects.emplace_back(glm::vec2( 0.0f, sim.court_radius.y+wall_radius)+o, glm::vec2(sim.court_radius.x, wall_radius), color);
+		};
+		draw_walls(s, shadow_color);
+		draw_walls(glm::vec2(0.0f), fg_color);
+		court_layer.upload(court_rects.data(), court_rects.size() * sizeof(court_rects[0]));
+		court_layer_radius = sim.court_radius;
+	}
+	size_t court_shadows = court_rects.size() / 2;
 
-	//inline helper function for rectangle drawing:
-	auto draw_rectangle = [&vertices](glm::vec2 const &center, glm::vec2 const &radius, glm::u8vec4 const &color) {
-		//draw rectangle as two CCW-oriented triangles:
-		vertices.emplace_back(glm::vec3(center.x-radius.x, center.y-radius.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
-		vertices.emplace_back(glm::vec3(center.x+radius.x, center.y-radius.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
-		vertices.emplace_back(glm::vec3(center.x+radius.x, center.y+radius.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
+	//scores:
+	if (score_layer_left != sim.left_score || score_layer_right != sim.right_score) {
+		score_rects.clear();
+		for (uint32_t i = 0; i < sim.left_score; ++i) {
+			score_rects.emplace_back(glm::vec2( -sim.court_radius.x + (2.0f + 3.0f * i) * score_radius.x, sim.court_radius.y + 2.0f * wall_radius + 2.0f * score_radius.y), score_radius, fg_color);
+		}
+		for (uint32_t i = 0; i < sim.right_score; ++i) {
+			score_rects.emplace_back(glm::vec2( sim.court_radius.x - (2.0f + 3.0f * i) * score_radius.x, sim.court_radius.y + 2.0f * wall_radius + 2.0f * score_radius.y), score_radius, fg_color);
+		}
+		score_layer.upload(score_rects.data(), score_rects.size() * sizeof(score_rects[0]));
+		score_layer_left = sim.left_score;
+		score_layer_right = sim.right_score;
+	}
 
-		vertices.emplace_back(glm::vec3(center.x-radius.x, center.y-radius.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
-		vertices.emplace_back(glm::vec3(center.x+radius.x, center.y+radius.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
-		vertices.emplace_back(glm::vec3(center.x-radius.x, center.y+radius.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
-	};
+	Renderer2D &renderer = *Renderer2D::current;
 
-	//shadows for everything (except the trail):
+	size_t arena_bytes = renderer.arena_bytes();
+	size_t entity_capacity = entity_at.capacity();
+	uint64_t allocations = allocation_count();
+	(void)allocations; //(only read by the assert below, which NDEBUG builds drop)
 
-	glm::vec2 s = glm::vec2(0.0f,-shadow_offset);
+	//interpolated positions of the entities:
+	entity_at.resize(sim.entities.size());
+	for (uint32_t i = 0; i < sim.entities.size(); ++i) {
+		entity_at[i] = glm::mix(sim.entities.previous[i], sim.entities.position[i], alpha);
+	}
+
+	//---- submit rectangles ----
+
+	//court and scores, from their retained buffers:
+	renderer.retained_rects(WallShadowLayer, court_layer, 0, uint32_t(court_shadows));
+	renderer.retained_rects(WallLayer, court_layer, uint32_t(court_shadows), uint32_t(court_rects.size() - court_shadows));
+	renderer.retained_rects(ScoreLayer, score_layer, 0, uint32_t(score_rects.size()));
 
-	draw_rectangle(glm::vec2(-court_radius.x-wall_radius, 0.0f)+s, glm::vec2(wall_radius, court_radius.y + 2.0f * wall_radius), shadow_color);
-	draw_rectangle(glm::vec2( court_radius.x+wall_radius, 0.0f)+s, glm::vec2(wall_radius, court_radius.y + 2.0f * wall_radius), shadow_color);
-	draw_rectangle(glm::vec2( 0.0f,-court_radius.y-wall_radius)+s, glm::vec2(court_radius.x, wall_radius), shadow_color);
-	draw_rectangle(glm::vec2( 0.0f, court_radius.y+wall_radius)+s, glm::vec2(court_radius.x, wall_radius), shadow_color);
-	draw_rectangle(left_paddle+s, paddle_radius, shadow_color);
-	draw_rectangle(right_paddle+s, paddle_radius, shadow_color);
-	draw_rectangle(ball+s, ball_radius, shadow_color);
+	//things that move are streamed:
+
+	//shadows for everything (except the trail):
+	for (uint32_t i = 0; i < sim.entities.size(); ++i) {
+		renderer.rect(ShadowLayer, entity_at[i]+s, sim.entities.radius[i], shadow_color);
+	}
 
 	//ball's trail:
-	if (ball_trail.size() >= 2) {
+	if (trail_tail - trail_head >= 2) {
 		//start ti at second element so there is always something before it to interpolate from:
-		std::deque< glm::vec3 >::iterator ti = ball_trail.begin() + 1;
+		uint32_t ti = trail_head + 1;
 		//draw trail from oldest-to-newest:
 		constexpr uint32_t STEPS = 20;
 		//draw from [STEPS, ..., 1]:
 		for (uint32_t step = STEPS; step > 0; --step) {
 			//time at which to draw the trail element:
-			float t = step / float(STEPS) * trail_length;
-			//advance ti until 'just before' t:
-			while (ti != ball_trail.end() && ti->z > t) ++ti;
+			double t = trail_time - step / double(STEPS) * trail_length;
+			//advance ti until 'just after' t:
+			while (ti != trail_tail && ball_trail[ti & trail_mask].time < t) ++ti;
 			//if we ran out of recorded tail, stop drawing:
-			if (ti == ball_trail.end()) break;
+			if (ti == trail_tail) break;
 			//interpolate between previous and current trail point to the correct time:
-			glm::vec3 a = *(ti-1);
-			glm::vec3 b = *(ti);
-			glm::vec2 at = (t - a.z) / (b.z - a.z) * (glm::vec2(b) - glm::vec2(a)) + glm::vec2(a);
+			TrailPoint const &a = ball_trail[(ti - 1) & trail_mask];
+			TrailPoint const &b = ball_trail[ti & trail_mask];
+			float f = (b.time > a.time ? float((t - a.time) / (b.time - a.time)) : 1.0f);
+			glm::vec2 at = f * (b.at - a.at) + a.at;
 
 			//look up color using linear interpolation:
 			//compute (continuous) index:
-			float c = (step-1) / float(STEPS-1) * trail_colors.size();
+			float c = (step-1) / float(STEPS-1) * TrailColorCount;
 			//split into an integer and fractional portion:
 			int32_t ci = int32_t(std::floor(c));
 			float cf = c - ci;
@@ -327,57 +188,44 @@ void PongMode::draw(glm::uvec2 const &drawable_size) {
 				ci = 0;
 				cf = 0.0f;
 			}
-			if (ci > int32_t(trail_colors.size())-2) {
-				ci = int32_t(trail_colors.size())-2;
+			if (ci > TrailColorCount-2) {
+				ci = TrailColorCount-2;
 				cf = 1.0f;
 			}
 			//do the interpolation (casting to floating point vectors because glm::mix doesn't have an overload for u8 vectors):
 			glm::u8vec4 color = glm::u8vec4(
-				glm::mix(glm::vec4(trail_colors[ci]), glm::vec4(trail_colors[ci+1]), cf)
+				glm::mix(glm::vec4(TrailColors[ci]), glm::vec4(TrailColors[ci+1]), cf)
 			);
 
 			//draw:
-			draw_rectangle(at, ball_radius, color);
+			renderer.rect(ShadowLayer, at, sim.entities.radius[sim.entities.at(sim.ball)], color);
 		}
 	}
 
 	//solid objects:
 
-	//walls:
-	draw_rectangle(glm::vec2(-court_radius.x-wall_radius, 0.0f), glm::vec2(wall_radius, court_radius.y + 2.0f * wall_radius), fg_color);
-	draw_rectangle(glm::vec2( court_radius.x+wall_radius, 0.0f), glm::vec2(wall_radius, court_radius.y + 2.0f * wall_radius), fg_color);
-	draw_rectangle(glm::vec2( 0.0f,-court_radius.y-wall_radius), glm::vec2(court_radius.x, wall_radius), fg_color);
-	draw_rectangle(glm::vec2( 0.0f, court_radius.y+wall_radius), glm::vec2(court_radius.x, wall_radius), fg_color);
-
-	//paddles:
-	draw_rectangle(left_paddle, paddle_radius, fg_color);
-	draw_rectangle(right_paddle, paddle_radius, fg_color);
-	
-
-	//ball:
-	draw_rectangle(ball, ball_radius, fg_color);
-
-	//scores:
-	glm::vec2 score_radius = glm::vec2(0.1f, 0.1f);
-	for (uint32_t i = 0; i < left_score; ++i) {
-		draw_rectangle(glm::vec2( -court_radius.x + (2.0f + 3.0f * i) * score_radius.x, court_radius.y + 2.0f * wall_radius + 2.0f * score_radius.y), score_radius, fg_color);
-	}
-	for (uint32_t i = 0; i < right_score; ++i) {
-		draw_rectangle(glm::vec2( court_radius.x - (2.0f + 3.0f * i) * score_radius.x, court_radius.y + 2.0f * wall_radius + 2.0f * score_radius.y), score_radius, fg_color);
+	//paddles and ball:
+	for (uint32_t i = 0; i < sim.entities.size(); ++i) {
+		renderer.rect(SolidLayer, entity_at[i], sim.entities.radius[i], sim.entities.color[i]);
 	}
 
-
+	//once the arenas are big enough, building a frame shouldn't touch the heap:
+	if (renderer.arena_bytes() != arena_bytes || entity_at.capacity() != entity_capacity) {
+		rect_arena_growths += 1;
+	} else {
+		assert(allocation_count() == allocations);
+	}
 
 	//------ compute court-to-window transform ------
 
 	//compute area that should be visible:
 	glm::vec2 scene_min = glm::vec2(
-		-court_radius.x - 2.0f * wall_radius - padding,
-		-court_radius.y - 2.0f * wall_radius - padding
+		-sim.court_radius.x - 2.0f * wall_radius - padding,
+		-sim.court_radius.y - 2.0f * wall_radius - padding
 	);
 	glm::vec2 scene_max = glm::vec2(
-		court_radius.x + 2.0f * wall_radius + padding,
-		court_radius.y + 2.0f * wall_radius + 3.0f * score_radius.y + padding
+		sim.court_radius.x + 2.0f * wall_radius + padding,
+		sim.court_radius.y + 2.0f * wall_radius + 3.0f * score_radius.y + padding
 	);
 
 	//compute window aspect ratio:
@@ -415,43 +263,6 @@ void PongMode::draw(glm::uvec2 const &drawable_size) {
 	glClearColor(bg_color.r / 255.0f, bg_color.g / 255.0f, bg_color.b / 255.0f, bg_color.a / 255.0f);
 	glClear(GL_COLOR_BUFFER_BIT);
 
-	//use alpha blending:
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	//don't use the depth test:
-	glDisable(GL_DEPTH_TEST);
-
-	//upload vertices to vertex_buffer:
-	glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer); //set vertex_buffer as current
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(vertices[0]), vertices.data(), GL_STREAM_DRAW); //upload vertices array
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-	//set color_texture_program as current program:
-	glUseProgram(color_texture_program.program);
-
-	//upload OBJECT_TO_CLIP to the proper uniform location:
-	glUniformMatrix4fv(color_texture_program.OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(court_to_clip));
-
-	//use the mapping vertex_buffer_for_color_texture_program to fetch vertex data:
-	glBindVertexArray(vertex_buffer_for_color_texture_program);
-
-	//bind the solid white texture to location zero so things will be drawn just with their colors:
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, white_tex);
-
-	//run the OpenGL pipeline:
-	glDrawArrays(GL_TRIANGLES, 0, GLsizei(vertices.size()));
-
-	//unbind the solid white texture:
-	glBindTexture(GL_TEXTURE_2D, 0);
-
-	//reset vertex array to none:
-	glBindVertexArray(0);
-
-	//reset current program to none:
-	glUseProgram(0);
-	
-
-	GL_ERRORS(); //PARANOIA: print errors just in case we did something wrong.
-
+	renderer.flush(court_to_clip);
 }
+
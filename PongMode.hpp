@@ -1,4 +1,5 @@
-#include "ColorTextureProgram.hpp"
+#include "Renderer2D.hpp"
+#include "PongSim.hpp"
 
 #include "Mode.hpp"
 #include "GL.hpp"
@@ -6,67 +7,67 @@
 #include <glm/glm.hpp>
 
 #include <vector>
-#include <deque>
 
 /*
  * PongMode is a game mode that implements a single-player game of Pong.
  */
 
 struct PongMode : Mode {
-	PongMode();
+	PongMode(uint32_t seed = 0);
 	virtual ~PongMode();
 
 	//functions called by main loop:
 	virtual bool handle_event(SDL_Event const &, glm::uvec2 const &window_size) override;
 	virtual void update(float elapsed) override;
-	virtual void draw(glm::uvec2 const &drawable_size) override;
+	virtual void draw(glm::uvec2 const &drawable_size, float alpha) override;
+	virtual std::string status() const override;
 
 	//----- game state -----
 
-	glm::vec2 court_radius = glm::vec2(7.0f, 5.0f);
-	glm::vec2 paddle_radius = glm::vec2(0.2f, 1.0f);
-	glm::vec2 ball_radius = glm::vec2(0.2f, 0.2f);
-
-	glm::vec2 left_paddle = glm::vec2(-court_radius.x + 0.5f, 0.0f);
-	glm::vec2 right_paddle = glm::vec2( court_radius.x - 0.5f, 0.0f);
-
-	glm::vec2 ball = glm::vec2(0.0f, 0.0f);
-	glm::vec2 ball_velocity = glm::vec2(-1.0f, 0.0f);
-
-	uint32_t left_score = 0;
-	uint32_t right_score = 0;
-
-	float ai_offset = 0.0f;
-	float ai_offset_update = 0.0f;
+	//(rules and state live in PongSim so they can also run headless)
+	PongSim sim;
 
 	//----- pretty gradient trails -----
 
 	float trail_length = 1.3f;
-	std::deque< glm::vec3 > ball_trail; //stores (x,y,age), oldest elements first
 
-	//----- opengl assets / helpers ------
-
-	//draw functions will work on vectors of vertices, defined as follows:
-	struct Vertex {
-		Vertex(glm::vec3 const &Position_, glm::u8vec4 const &Color_, glm::vec2 const &TexCoord_) :
-			Position(Position_), Color(Color_), TexCoord(TexCoord_) { }
-		glm::vec3 Position;
-		glm::u8vec4 Color;
-		glm::vec2 TexCoord;
+	//where the ball has been, oldest first, in a fixed-capacity ring.
+	//Points are stamped with the time they were reached (not aged every update),
+	// and every bounce is recorded, so the trail follows the ball's exact path at any update rate:
+	struct TrailPoint {
+		glm::vec2 at;
+		double time; //seconds of updates since the mode started
 	};
-	static_assert(sizeof(Vertex) == 4*3 + 1*4 + 4*2, "PongMode::Vertex should be packed");
-
-	//Shader program that draws transformed, vertices tinted with vertex colors:
-	ColorTextureProgram color_texture_program;
+	std::vector< TrailPoint > ball_trail; //size is a power of two, fixed at construction
+	uint32_t trail_mask = 0; //ball_trail.size() - 1
+	uint32_t trail_head = 0; //id of oldest point; point 'id' is at ball_trail[id & trail_mask]
+	uint32_t trail_tail = 0; //one past id of newest point
+	double trail_time = 0.0; //time of the last update
+	//(if the ring is full, the oldest point is dropped)
+	void add_trail_point(glm::vec2 const &at, double time);
 
-	//Buffer used to hold vertex data during drawing:
-	GLuint vertex_buffer = 0;
+	//----- opengl assets / helpers ------
 
-	//Vertex Array Object that maps buffer locations to color_texture_program attribute locations:
-	GLuint vertex_buffer_for_color_texture_program = 0;
+	//everything is drawn as solid rectangles through Renderer2D, in these layers (back to front):
+	enum Layer : uint8_t {
+		WallShadowLayer,
+		ShadowLayer, //(entity shadows and the ball's trail)
+		WallLayer,
+		SolidLayer,
+		ScoreLayer,
+	};
 
-	//Solid white texture:
-	GLuint white_tex = 0;
+	std::vector< glm::vec2 > entity_at; //interpolated entity positions (reused every frame)
+	uint32_t rect_arena_growths = 0; //frames on which this or the renderer's arenas had to grow
+
+	//The court (wall shadows, then walls) and the score dots rarely change, so they are kept in
+	// retained buffers and only rebuilt when the court size or the score changes:
+	std::vector< RectProgram::Instance > court_rects;
+	RetainedBuffer court_layer{GL_STATIC_DRAW};
+	glm::vec2 court_layer_radius = glm::vec2(0.0f); //court size court_layer was built for
+	std::vector< RectProgram::Instance > score_rects;
+	RetainedBuffer score_layer{GL_DYNAMIC_DRAW};
+	uint32_t score_layer_left = ~0U, score_layer_right = ~0U; //scores score_layer shows
 
 	//matrix that maps from clip coordinates to court-space coordinates:
 	glm::mat3x2 clip_to_court = glm::mat3x2(1.0f);
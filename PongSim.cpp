@@ -0,0 +1,367 @@
+#include "PongSim.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+PongSim::PongSim(uint32_t seed) : rng(seed) {
+	const glm::u8vec4 fg_color = glm::u8vec4(0xf2, 0xd2, 0xb6, 0xff);
+	entities.reset(3);
+	left_paddle = entities.create(Paddle, glm::vec2(-court_radius.x + 0.5f, 0.0f), paddle_radius, glm::vec2(0.0f), fg_color);
+	right_paddle = entities.create(Paddle, glm::vec2( court_radius.x - 0.5f, 0.0f), paddle_radius, glm::vec2(0.0f), fg_color);
+	ball = entities.create(Ball, glm::vec2(0.0f, 0.0f), ball_radius, glm::vec2(-1.0f, 0.0f), fg_color);
+
+	bounce_points.reserve(max_bounce_points);
+}
+
+void PongSim::set_left_paddle(float y) {
+	uint32_t left = entities.at(left_paddle);
+	entities.position[left].y = y;
+	entities.previous[left].y = y; //(mouse motion isn't interpolated)
+}
+
+float PongSim::speed_multiplier() const {
+	//(there's no speed cap, since the ball can't tunnel; the exponent is only limited to keep the arithmetic finite)
+	return 4.0f * std::pow(2.0f, std::min((left_score + right_score) / 4.0f, 64.0f));
+}
+
+//Fold a height 'u' in the "unfolded" court, where the top and bottom walls mirror the court instead
+// of bouncing the ball, back into [-limit, limit]. Copy k of the court covers [(2k-1) limit, (2k+1) limit]
+// and odd copies are upside down; *flipped (if given) is set when u is in one, i.e. when the ball's
+// y velocity is reversed in the real court:
+static double fold(double u, double limit, bool *flipped) {
+	double copy = std::floor((u + limit) / (2.0 * limit));
+	double along = (u + limit) - copy * (2.0 * limit);
+	bool odd = (std::fmod(std::abs(copy), 2.0) == 1.0);
+	if (flipped) *flipped = odd;
+	return (odd ? limit - along : along - limit);
+}
+
+float PongSim::predict_ball_y(float x) const {
+	uint32_t b = entities.at(ball);
+	glm::vec2 const &at = entities.position[b];
+	glm::vec2 const &velocity = entities.velocity[b];
+	float limit = court_radius.y - entities.radius[b].y;
+	if (velocity.x == 0.0f || limit <= 0.0f) return at.y;
+
+	//where the ball would be with no top and bottom walls:
+	float y = at.y + (x - at.x) * (velocity.y / velocity.x);
+
+	//walls mirror the path, so fold it back into the court:
+	return float(fold(y, limit, nullptr));
+}
+
+void PongSim::update_ai(AI &ai, EntityStore::Handle paddle, float elapsed) {
+	uint32_t p = entities.at(paddle);
+	uint32_t b = entities.at(ball);
+	glm::vec2 &at = entities.position[p];
+	glm::vec2 const &ball_at = entities.position[b];
+	glm::vec2 const &ball_velocity = entities.velocity[b];
+
+	//re-plan only when the ball changes direction (a bounce or a serve):
+	if (ball_velocity != ai.seen_velocity) {
+		ai.seen_velocity = ball_velocity;
+		//the ball meets the paddle when its center reaches the paddle's court-side face:
+		float face = at.x + (at.x > 0.0f ? -1.0f : 1.0f) * (entities.radius[p].x + entities.radius[b].x);
+		if ((face - ball_at.x) * ball_velocity.x > 0.0f) {
+			float miss = ((rng() / float(rng.max())) * 2.0f - 1.0f) * ai.error;
+			ai.next_target = predict_ball_y(face) + miss;
+		} else {
+			//ball is heading away; wait in the middle:
+			ai.next_target = 0.0f;
+		}
+		ai.wait = ai.reaction;
+		ai.predictions += 1;
+	}
+
+	if (ai.wait > 0.0f) ai.wait -= elapsed;
+	if (ai.wait <= 0.0f) ai.target = ai.next_target;
+
+	if (at.y < ai.target) {
+		at.y = std::min(ai.target, at.y + ai.speed * elapsed);
+	} else {
+		at.y = std::max(ai.target, at.y - ai.speed * elapsed);
+	}
+}
+
+//If a point moving from 'from' by 'motion' enters the box at 'center' (with half-size 'radius'),
+// set *t to the fraction of 'motion' at which it does and *axis to the side it enters through (0: x, 1: y).
+//A point that starts inside the box doesn't count as entering it.
+static bool point_enters_box(glm::dvec2 const &from, glm::dvec2 const &motion, glm::dvec2 const &center, glm::dvec2 const &radius, double *t, int *axis) {
+	double enter = -std::numeric_limits< double >::infinity();
+	double leave = std::numeric_limits< double >::infinity();
+	int enter_axis = -1;
+	for (int a = 0; a < 2; ++a) {
+		double lo = center[a] - radius[a];
+		double hi = center[a] + radius[a];
+		if (motion[a] == 0.0) {
+			if (from[a] < lo || from[a] > hi) return false;
+			continue;
+		}
+		double t0 = (lo - from[a]) / motion[a];
+		double t1 = (hi - from[a]) / motion[a];
+		if (t0 > t1) std::swap(t0, t1);
+		if (t0 > enter) {
+			enter = t0;
+			enter_axis = a;
+		}
+		leave = std::min(leave, t1);
+	}
+	if (enter_axis < 0 || enter > leave || enter < 0.0 || enter > 1.0) return false;
+	*t = enter;
+	*axis = enter_axis;
+	return true;
+}
+
+void PongSim::update(float elapsed) {
+
+	//remember where things were so draw() can interpolate:
+	entities.save_previous();
+
+	uint32_t b = entities.at(ball);
+	glm::vec2 &ball_at = entities.position[b];
+	glm::vec2 &ball_velocity = entities.velocity[b];
+	glm::vec2 const &ball_size = entities.radius[b];
+
+	//----- paddle update -----
+
+	update_ai(right_ai, right_paddle, elapsed);
+	if (left_ai_playing) update_ai(left_ai, left_paddle, elapsed);
+
+	//clamp paddles to court:
+	for (uint32_t i = 0; i < entities.size(); ++i) {
+		if (entities.kind[i] != Paddle) continue;
+		float limit = court_radius.y - entities.radius[i].y;
+		entities.position[i].y = std::max(entities.position[i].y, -limit);
+		entities.position[i].y = std::min(entities.position[i].y,  limit);
+	}
+
+	//the ball's center stays in the court shrunk by the ball's size:
+	glm::vec2 limit = court_radius - ball_size;
+
+	//a paddle that moved onto the ball pushes it out, through whichever side
+	// is the shortest move (among those that leave the ball in the court, so a
+	// ball caught between a paddle and a wall comes out the open side):
+	auto paddle_vs_ball = [&](uint32_t p) {
+		glm::vec2 const &paddle = entities.position[p];
+		glm::vec2 reach = entities.radius[p] + ball_size;
+
+		//if no overlap, no collision:
+		glm::vec2 offset = ball_at - paddle;
+		if (std::abs(offset.x) >= reach.x || std::abs(offset.y) >= reach.y) return;
+
+		int best_axis = -1;
+		float best_side = 0.0f;
+		float best_move = std::numeric_limits< float >::infinity();
+		for (int a = 0; a < 2; ++a) {
+			for (float side : {1.0f, -1.0f}) {
+				float to = paddle[a] + side * reach[a];
+				float move = std::abs(to - ball_at[a]);
+				if (std::abs(to) <= limit[a] && move < best_move) {
+					best_axis = a;
+					best_side = side;
+					best_move = move;
+				}
+			}
+		}
+		if (best_axis < 0) return; //(no room anywhere; can't happen with paddles that fit in the court)
+
+		ball_at[best_axis] = paddle[best_axis] + best_side * reach[best_axis];
+		ball_velocity[best_axis] = best_side * std::abs(ball_velocity[best_axis]);
+		if (best_axis == 0) {
+			//warp y velocity based on offset from paddle center:
+			float vel = (ball_at.y - paddle.y) / reach.y;
+			ball_velocity.y = glm::mix(ball_velocity.y, vel, 0.75f);
+		}
+	};
+	for (uint32_t i = 0; i < entities.size(); ++i) {
+		if (entities.kind[i] == Paddle) paddle_vs_ball(i);
+	}
+
+	ball_at = glm::clamp(ball_at, -limit, limit);
+
+	//----- ball update -----
+
+	//The top and bottom walls only mirror the ball's path, so the ball is moved through the unfolded
+	// court (see fold() above), where its height changes in a straight line however many times it
+	// bounces off them. Each step goes to the first paddle -- or mirrored copy of a paddle -- or side
+	// wall the ball touches, bounces, and continues with the time left over:
+	float speed = speed_multiplier();
+	float remaining = elapsed;
+	double const wall = limit.y;
+
+	//between two paddle bounces the ball has to cross the gap between paddles, so how far it moves in x
+	// bounds the paddle bounces this update can need (spare_bounces covers the ends of the update):
+	double gap = std::numeric_limits< double >::infinity();
+	for (uint32_t i = 0; i < entities.size(); ++i) {
+		if (entities.kind[i] != Paddle) continue;
+		for (uint32_t j = i + 1; j < entities.size(); ++j) {
+			if (entities.kind[j] != Paddle) continue;
+			float between = std::abs(entities.position[i].x - entities.position[j].x) - entities.radius[i].x - entities.radius[j].x - 2.0f * ball_size.x;
+			gap = std::min(gap, double(between));
+		}
+	}
+	double travel = std::abs(double(ball_velocity.x) * double(speed) * double(elapsed));
+	uint64_t bounce_budget = spare_bounces;
+	if (gap > 0.0) bounce_budget += uint64_t(std::min(std::ceil(travel / gap), 1e18));
+	uint64_t paddle_bounces = 0;
+	bounces = 0;
+	bounce_points.clear();
+
+	auto add_bounce_point = [&](double x, double y, float seconds) {
+		//(past max_bounce_points the path between the recorded points is only approximate)
+		if (bounce_points.size() < max_bounce_points) bounce_points.emplace_back(float(x), float(y), seconds);
+	};
+	//count (and record) the bounces on a straight path from 'from' by 'motion' in an unfolded court
+	// folded at 'mid' +/- 'half', taking 'seconds' and starting 'start' seconds into the update:
+	auto add_folds = [&](glm::dvec2 const &from, glm::dvec2 const &motion, double mid, double half, float start, double seconds) {
+		double from_copy = std::floor((from.y - mid + half) / (2.0 * half));
+		double to_copy = std::floor((from.y + motion.y - mid + half) / (2.0 * half));
+		uint64_t crossed = uint64_t(std::min(std::abs(to_copy - from_copy), 1e18));
+		for (uint64_t c = 0; c < crossed && bounce_points.size() < max_bounce_points; ++c) {
+			double boundary = mid + (to_copy > from_copy ? 2.0 * (from_copy + c) + 1.0 : 2.0 * (from_copy - c) - 1.0) * half;
+			double t = (boundary - from.y) / motion.y;
+			add_bounce_point(from.x + motion.x * t, mid + fold(boundary - mid, half, nullptr), start + float(seconds * t));
+		}
+		bounces += crossed;
+	};
+
+	while (remaining > 0.0f) {
+		if (paddle_bounces >= bounce_budget) {
+			dropped_seconds += remaining;
+			break;
+		}
+
+		glm::dvec2 from = glm::dvec2(ball_at);
+		glm::dvec2 motion = glm::dvec2(ball_velocity) * (double(speed) * double(remaining));
+
+		enum { None, SideWall, PaddleSide } hit = None;
+		double hit_t = 1.0;
+		int hit_axis = 0;
+		uint32_t hit_paddle = 0;
+		glm::dvec2 hit_center = glm::dvec2(0.0); //(of the copy of the paddle that was hit)
+
+		//side walls:
+		if (motion.x > 0.0 && from.x + motion.x > limit.x) {
+			hit = SideWall;
+			hit_t = (limit.x - from.x) / motion.x;
+		} else if (motion.x < 0.0 && from.x + motion.x < -limit.x) {
+			hit = SideWall;
+			hit_t = (-limit.x - from.x) / motion.x;
+		}
+
+		//paddles (the ball's center against each paddle grown by the ball's size), checking each
+		// copy of the court the ball passes through while it is level with the paddle in x:
+		for (uint32_t i = 0; i < entities.size(); ++i) {
+			if (entities.kind[i] != Paddle) continue;
+			glm::dvec2 paddle = glm::dvec2(entities.position[i]);
+			glm::dvec2 reach = glm::dvec2(entities.radius[i] + ball_size);
+
+			double t0 = 0.0;
+			double t1 = hit_t;
+			if (motion.x != 0.0) {
+				double a = (paddle.x - reach.x - from.x) / motion.x;
+				double b = (paddle.x + reach.x - from.x) / motion.x;
+				t0 = std::max(t0, std::min(a, b));
+				t1 = std::min(t1, std::max(a, b));
+			} else if (std::abs(from.x - paddle.x) > reach.x) {
+				continue;
+			}
+			if (t0 > t1) continue;
+
+			//(a copy reaches up to 'reach' past the ends of its stretch of court, hence the extra copy on each end)
+			double y0 = from.y + motion.y * t0;
+			double y1 = from.y + motion.y * t1;
+			double first = std::floor((std::min(y0, y1) + wall) / (2.0 * wall)) - 1.0;
+			double last = std::floor((std::max(y0, y1) + wall) / (2.0 * wall)) + 1.0;
+			for (double copy = first; copy <= last; copy += 1.0) {
+				bool odd = (std::fmod(std::abs(copy), 2.0) == 1.0);
+				glm::dvec2 center = glm::dvec2(paddle.x, 2.0 * wall * copy + (odd ? -paddle.y : paddle.y));
+				double t;
+				int axis;
+				//(tested a hair small, so a ball that rounding left just inside a copy still bounces off it)
+				if (point_enters_box(from, motion, center, reach - 1e-5, &t, &axis) && t < hit_t) {
+					hit = PaddleSide;
+					hit_t = t;
+					hit_axis = axis;
+					hit_paddle = i;
+					hit_center = center;
+				}
+			}
+		}
+
+		hit_t = std::max(hit_t, 0.0);
+		glm::dvec2 to = from + motion * hit_t;
+		add_folds(from, motion * hit_t, 0.0, wall, elapsed - remaining, remaining * hit_t);
+		remaining -= float(remaining * hit_t);
+
+		//the ball's velocity in the unfolded court:
+		glm::vec2 velocity = ball_velocity;
+
+		if (hit == SideWall) {
+			//(set the ball exactly on the wall, since from + motion * hit_t may round past it)
+			to.x = (motion.x > 0.0 ? limit.x : -limit.x);
+			velocity.x = -velocity.x;
+			//side walls score:
+			if (motion.x > 0.0) left_score += 1;
+			else right_score += 1;
+		} else if (hit == PaddleSide) {
+			glm::dvec2 reach = glm::dvec2(entities.radius[hit_paddle] + ball_size);
+			double side = (motion[hit_axis] > 0.0 ? -1.0 : 1.0);
+			to[hit_axis] = hit_center[hit_axis] + side * reach[hit_axis];
+			velocity[hit_axis] = float(side) * std::abs(velocity[hit_axis]);
+			paddle_bounces += 1;
+		}
+
+		//back into the real court:
+		bool flipped = false;
+		ball_at = glm::vec2(float(to.x), float(fold(to.y, wall, &flipped)));
+		ball_velocity = glm::vec2(velocity.x, flipped ? -velocity.y : velocity.y);
+
+		if (hit == None) break;
+		bounces += 1;
+		add_bounce_point(ball_at.x, ball_at.y, elapsed - remaining);
+
+		//a point ends the update (the ball waits at the wall for the rest of it), so an update scores at most once:
+		if (hit == SideWall) break;
+
+		glm::vec2 const &paddle = entities.position[hit_paddle];
+		glm::vec2 reach = entities.radius[hit_paddle] + ball_size;
+		if (hit_axis == 0) {
+			//warp y velocity based on offset from paddle center:
+			float vel = (ball_at.y - paddle.y) / reach.y;
+			ball_velocity.y = glm::mix(ball_velocity.y, vel, 0.75f);
+		} else if (remaining > 0.0f) {
+			//off the end of a paddle, the ball is in the channel between that end and the wall beyond it; it
+			// only bounces between the two until it leaves the paddle's x span (or reaches the side wall), so
+			// fold that run in one go as well, or a thin channel would use up the bounces:
+			// (the channel comes from the paddle rather than the fold, which can't tell which side of a
+			// paddle end that touches the wall the ball is on)
+			float side = (ball_at.y > paddle.y ? 1.0f : -1.0f);
+			double end = side * wall;
+			double face = side * std::min(double(side * (paddle.y + side * reach.y)), wall);
+			ball_at.y = float(face);
+			ball_velocity.y = side * std::abs(ball_velocity.y);
+
+			glm::dvec2 channel_from = glm::dvec2(ball_at);
+			glm::dvec2 channel_motion = glm::dvec2(ball_velocity) * (double(speed) * double(remaining));
+			double t = 1.0;
+			if (channel_motion.x != 0.0) {
+				double edge = paddle.x + (channel_motion.x > 0.0 ? reach.x : -reach.x);
+				double side_wall = (channel_motion.x > 0.0 ? limit.x : -limit.x);
+				t = std::min(t, std::min(std::abs(edge - channel_from.x), std::abs(side_wall - channel_from.x)) / std::abs(channel_motion.x));
+			}
+
+			double half = 0.5 * std::abs(end - face);
+			if (half > 1e-4) {
+				double mid = 0.5 * (face + end);
+				add_folds(channel_from, channel_motion * t, mid, half, elapsed - remaining, remaining * t);
+				ball_at.y = float(mid + fold(channel_from.y + channel_motion.y * t - mid, half, &flipped));
+				if (flipped) ball_velocity.y = -ball_velocity.y;
+			}
+			//(a channel with no room to bounce in just lets the ball slide along it)
+			ball_at.x = float(channel_from.x + channel_motion.x * t);
+			remaining -= float(remaining * t);
+		}
+	}
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "Pcg32.hpp"
+#include "EntityStore.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstdint>
+
+/*
+ * PongSim holds the game state and rules for PongMode: two paddles (the
+ *  left one placed by the player, the right one by a simple AI) and a ball
+ *  that speeds up as points are scored.
+ *
+ * The ball is moved with swept collision: each step it travels to the
+ *  first paddle or side wall it would touch, bounces, and continues with
+ *  the time left over, so it can't pass through anything however fast it
+ *  goes or however long the step is. Bounces off the top and bottom walls
+ *  are folded in analytically (as in predict_ball_y()) rather than taking
+ *  steps, and a point ends the update. So an update costs one step per
+ *  paddle bounce, plus one bounce point per wall bounce up to
+ *  max_bounce_points (later wall bounces are only counted). Each step also
+ *  tests the mirrored copies of a paddle that the ball passes while level
+ *  with it, usually two or three copies.
+ *
+ * Paddles can be played by an AI that works out where the ball will cross
+ *  its paddle (unfolding wall bounces analytically) once each time the ball
+ *  changes direction, then moves there; see PongSim::AI.
+ *
+ * Like TankSim, it has no SDL or OpenGL dependencies (see pong_sim_main.cpp).
+ */
+
+struct PongSim {
+	explicit PongSim(uint32_t seed = 0);
+
+	//advance the simulation by 'elapsed' seconds:
+	void update(float elapsed);
+
+	//----- input -----
+	//put the left paddle at height y (it is clamped to the court on the next update):
+	void set_left_paddle(float y);
+
+	//----- settings -----
+	glm::vec2 court_radius = glm::vec2(7.0f, 5.0f);
+	glm::vec2 paddle_radius = glm::vec2(0.2f, 1.0f);
+	glm::vec2 ball_radius = glm::vec2(0.2f, 0.2f);
+
+	//paddle bounces allowed in one update beyond the ones its distance covered can need
+	// (any time left after that is dropped, and counted in dropped_seconds):
+	uint32_t spare_bounces = 64;
+	//most bounce_points kept per update:
+	uint32_t max_bounce_points = 256;
+
+	//----- state -----
+
+	//paddles and ball live in the entity store (created by the constructor, in this order):
+	EntityStore entities;
+	enum : uint8_t { Paddle = 1, Ball = 2 };
+	EntityStore::Handle left_paddle, right_paddle, ball;
+	//(the ball's velocity is a direction; update() scales it by speed_multiplier())
+
+	uint32_t left_score = 0;
+	uint32_t right_score = 0;
+
+	//speed of ball doubles every four points:
+	float speed_multiplier() const;
+
+	//----- paddle AI -----
+	struct AI {
+		//difficulty:
+		float reaction = 0.15f; //seconds before the paddle reacts to a new ball direction
+		float error = 1.25f; //aim is off by up to this much (court units) each time
+		float speed = 2.0f; //paddle speed (court units per second)
+
+		//prediction, cached until the ball's velocity changes:
+		glm::vec2 seen_velocity = glm::vec2(0.0f);
+		float next_target = 0.0f; //where to go once 'wait' runs out
+		float wait = 0.0f;
+		float target = 0.0f; //where the paddle is heading now
+		uint32_t predictions = 0;
+	};
+	AI right_ai;
+	AI left_ai; //(only used if left_ai_playing)
+	bool left_ai_playing = false;
+
+	//move 'paddle' as 'ai' directs (called by update()):
+	void update_ai(AI &ai, EntityStore::Handle paddle, float elapsed);
+
+	//height at which the ball's center will reach 'x' if it keeps going (bouncing off the top and bottom walls);
+	// only meaningful if the ball is heading toward x:
+	float predict_ball_y(float x) const;
+
+	GameRng rng; //(seeded by the constructor)
+
+	//bounces resolved in the last update, and where and when (x, y, seconds into the update) each happened:
+	// (the ball moves in a straight line between them, so these plus its positions give its exact path)
+	uint64_t bounces = 0;
+	std::vector< glm::vec3 > bounce_points; //(reserved by the constructor for max_bounce_points)
+
+	//total time updates have dropped because the ball ran out of bounces (should stay zero):
+	double dropped_seconds = 0.0;
+};
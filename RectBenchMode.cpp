@@ -0,0 +1,226 @@
+#include "RectBenchMode.hpp"
+
+//for the GL_ERRORS() macro:
+#include "gl_errors.hpp"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+
+RectBenchMode::RectBenchMode(uint32_t frames_per_test_) : frames_per_test(frames_per_test_) {
+	for (uint32_t count : {1000, 10000, 100000}) {
+		for (Path path : {Textured, Color, Instances}) {
+			tests.emplace_back();
+			tests.back().rects = count;
+			tests.back().path = path;
+		}
+	}
+
+	//----- allocate OpenGL resources -----
+	{ //vertex array mapping buffer for color_texture_program:
+		//ask OpenGL to fill vertex_buffer_for_color_texture_program with the name of an unused vertex array object:
+		glGenVertexArrays(1, &vertex_buffer_for_color_texture_program);
+
+		//set vertex_buffer_for_color_texture_program as the current vertex array object:
+		glBindVertexArray(vertex_buffer_for_color_texture_program);
+
+		//set vertex_stream's buffer as the source of glVertexAttribPointer() commands:
+		glBindBuffer(GL_ARRAY_BUFFER, vertex_stream.buffer);
+
+		//set up the vertex array object to describe arrays of TexturedVertex:
+		TexturedVertex::bind_attributes(color_texture_program);
+
+		//done referring to vertex_stream's buffer, so unbind it:
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		//done setting up vertex array object, so unbind it:
+		glBindVertexArray(0);
+
+		GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+	}
+
+	{ //vertex array mapping buffer for color_program:
+		glGenVertexArrays(1, &vertex_buffer_for_color_program);
+		glBindVertexArray(vertex_buffer_for_color_program);
+		glBindBuffer(GL_ARRAY_BUFFER, vertex_stream.buffer);
+		ColorVertex::bind_attributes(color_program);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindVertexArray(0);
+
+		GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+	}
+
+	//vertex array for rect_program (its attributes are pointed at vertex_stream in draw()):
+	glGenVertexArrays(1, &vertex_buffer_for_rect_program);
+
+	{ //solid white texture:
+		//ask OpenGL to fill white_tex with the name of an unused texture object:
+		glGenTextures(1, &white_tex);
+
+		//bind that texture object as a GL_TEXTURE_2D-type texture:
+		glBindTexture(GL_TEXTURE_2D, white_tex);
+
+		//upload a 1x1 image of solid white to the texture:
+		glm::uvec2 size = glm::uvec2(1,1);
+		std::vector< glm::u8vec4 > data(size.x*size.y, glm::u8vec4(0xff, 0xff, 0xff, 0xff));
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size.x, size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, data.data());
+
+		//set filtering and wrapping parameters:
+		//(it's a bit silly to mipmap a 1x1 texture, but I'm doing it because you may want to use this code to load different sizes of texture)
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+		//since texture uses a mipmap and we haven't uploaded one, instruct opengl to make one for us:
+		glGenerateMipmap(GL_TEXTURE_2D);
+
+		//Okay, texture uploaded, can unbind it:
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+	}
+}
+
+RectBenchMode::~RectBenchMode() {
+	//----- free OpenGL resources -----
+	glDeleteVertexArrays(1, &vertex_buffer_for_color_texture_program);
+	vertex_buffer_for_color_texture_program = 0;
+
+	glDeleteVertexArrays(1, &vertex_buffer_for_color_program);
+	vertex_buffer_for_color_program = 0;
+
+	glDeleteVertexArrays(1, &vertex_buffer_for_rect_program);
+	vertex_buffer_for_rect_program = 0;
+
+	glDeleteTextures(1, &white_tex);
+	white_tex = 0;
+}
+
+void RectBenchMode::draw(glm::uvec2 const &drawable_size, float alpha) {
+	if (test >= tests.size()) return;
+	Test &current = tests[test];
+
+	auto now = [](){
+		return std::chrono::duration< double >(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+	};
+	double before = now();
+
+	//---- compute rectangles to draw ----
+
+	//a grid of small rectangles covering clip space, each wobbling on its own phase:
+	uint32_t side = uint32_t(std::ceil(std::sqrt(float(current.rects))));
+	glm::vec2 radius = glm::vec2(0.8f / side);
+	float t = frame / 60.0f;
+
+	textured_vertices.clear();
+	color_vertices.clear();
+	rects.clear();
+	for (uint32_t i = 0; i < current.rects; ++i) {
+		glm::vec2 center = glm::vec2(
+			((i % side) + 0.5f) / side * 2.0f - 1.0f,
+			((i / side) + 0.5f) / side * 2.0f - 1.0f
+		) + radius * std::sin(t + 0.1f * i);
+		glm::u8vec4 color = glm::u8vec4(0x40 + (i * 37) % 0xc0, 0x40 + (i * 91) % 0xc0, 0xb0, 0xff);
+		if (current.path == Textured) {
+			//draw rectangle as two CCW-oriented triangles:
+			textured_vertices.emplace_back(glm::vec3(center.x-radius.x, center.y-radius.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
+			textured_vertices.emplace_back(glm::vec3(center.x+radius.x, center.y-radius.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
+			textured_vertices.emplace_back(glm::vec3(center.x+radius.x, center.y+radius.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
+
+			textured_vertices.emplace_back(glm::vec3(center.x-radius.x, center.y-radius.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
+			textured_vertices.emplace_back(glm::vec3(center.x+radius.x, center.y+radius.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
+			textured_vertices.emplace_back(glm::vec3(center.x-radius.x, center.y+radius.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
+		} else if (current.path == Color) {
+			color_vertices.emplace_back(glm::vec3(center.x-radius.x, center.y-radius.y, 0.0f), color);
+			color_vertices.emplace_back(glm::vec3(center.x+radius.x, center.y-radius.y, 0.0f), color);
+			color_vertices.emplace_back(glm::vec3(center.x+radius.x, center.y+radius.y, 0.0f), color);
+
+			color_vertices.emplace_back(glm::vec3(center.x-radius.x, center.y-radius.y, 0.0f), color);
+			color_vertices.emplace_back(glm::vec3(center.x+radius.x, center.y+radius.y, 0.0f), color);
+			color_vertices.emplace_back(glm::vec3(center.x-radius.x, center.y+radius.y, 0.0f), color);
+		} else {
+			rects.emplace_back(center, radius, color);
+		}
+	}
+	double after_build = now();
+
+	//---- actual drawing ----
+
+	glClearColor(0.1f, 0.23f, 0.35f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glDisable(GL_DEPTH_TEST);
+
+	glm::mat4 identity = glm::mat4(1.0f);
+	uint64_t bytes_before = vertex_stream.bytes;
+
+	if (current.path == Textured) {
+		GLintptr offset = vertex_stream.write(textured_vertices.data(), textured_vertices.size() * sizeof(textured_vertices[0]), sizeof(textured_vertices[0]));
+		glUseProgram(color_texture_program.program);
+		glUniformMatrix4fv(color_texture_program.OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(identity));
+		glBindVertexArray(vertex_buffer_for_color_texture_program);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, white_tex);
+		glDrawArrays(GL_TRIANGLES, GLint(offset / sizeof(textured_vertices[0])), GLsizei(textured_vertices.size()));
+		glBindTexture(GL_TEXTURE_2D, 0);
+	} else if (current.path == Color) {
+		GLintptr offset = vertex_stream.write(color_vertices.data(), color_vertices.size() * sizeof(color_vertices[0]), sizeof(color_vertices[0]));
+		glUseProgram(color_program.program);
+		glUniformMatrix4fv(color_program.OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(identity));
+		glBindVertexArray(vertex_buffer_for_color_program);
+		glDrawArrays(GL_TRIANGLES, GLint(offset / sizeof(color_vertices[0])), GLsizei(color_vertices.size()));
+	} else {
+		GLintptr offset = vertex_stream.write(rects.data(), rects.size() * sizeof(rects[0]), sizeof(rects[0]));
+		glUseProgram(rect_program.program);
+		glUniformMatrix4fv(rect_program.OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(identity));
+		glBindVertexArray(vertex_buffer_for_rect_program);
+		glBindBuffer(GL_ARRAY_BUFFER, vertex_stream.buffer);
+		rect_program.bind_instances(offset);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 6, GLsizei(rects.size()));
+	}
+	vertex_stream.end_frame();
+	glBindVertexArray(0);
+	glUseProgram(0);
+
+	//(wait for the GPU, so the frame time includes the upload and the draw)
+	glFinish();
+	double after = now();
+
+	GL_ERRORS(); //PARANOIA: print errors just in case we did something wrong.
+
+	if (frame >= warmup_frames) {
+		current.build += after_build - before;
+		current.frame += after - before;
+		current.bytes += vertex_stream.bytes - bytes_before;
+	}
+
+	frame += 1;
+	if (frame == warmup_frames + frames_per_test) {
+		frame = 0;
+		test += 1;
+		if (test == tests.size()) {
+			print_results();
+			Mode::set_current(nullptr);
+		}
+	}
+}
+
+void RectBenchMode::print_results() const {
+	std::cout << "Rectangles, " << frames_per_test << " frames each (frame = build + upload + draw + glFinish):\n";
+	std::cout << std::setw(10) << "rects" << std::setw(12) << "path" << std::setw(12) << "build ms" << std::setw(12) << "frame ms" << std::setw(16) << "bytes/frame" << "\n";
+	std::cout << std::fixed << std::setprecision(3);
+	for (Test const &t : tests) {
+		std::cout << std::setw(10) << t.rects << std::setw(12) << (t.path == Textured ? "textured" : t.path == Color ? "color" : "instances")
+		          << std::setw(12) << t.build / frames_per_test * 1e3
+		          << std::setw(12) << t.frame / frames_per_test * 1e3
+		          << std::setw(16) << t.bytes / frames_per_test << "\n";
+	}
+	std::cout.unsetf(std::ios::fixed);
+	std::cout.flush();
+}
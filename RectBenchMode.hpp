@@ -0,0 +1,74 @@
+#include "DrawVertex.hpp"
+#include "RectProgram.hpp"
+#include "StreamBuffer.hpp"
+
+#include "Mode.hpp"
+#include "GL.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/*
+ * RectBenchMode draws moving rectangles three ways and times them:
+ *  - "textured": six textured vertices per rectangle (ColorTextureProgram sampling a white texture), built on the CPU;
+ *  - "color": six color-only vertices per rectangle (ColorProgram), built on the CPU;
+ *  - "instances": one RectProgram instance per rectangle, expanded on the GPU.
+ * It runs each way at several rectangle counts, prints a table, and quits.
+ */
+
+struct RectBenchMode : Mode {
+	RectBenchMode(uint32_t frames_per_test = 240);
+	virtual ~RectBenchMode();
+
+	//functions called by main loop:
+	virtual void draw(glm::uvec2 const &drawable_size, float alpha) override;
+
+	//----- tests -----
+	enum Path : uint32_t { Textured = 0, Color = 1, Instances = 2 };
+	struct Test {
+		uint32_t rects;
+		Path path;
+		//results, summed over the timed frames:
+		double build = 0.0; //seconds filling the vertex / instance arena
+		double frame = 0.0; //seconds for build + upload + draw, waiting for the GPU to finish
+		uint64_t bytes = 0; //bytes written to the stream buffer
+	};
+	std::vector< Test > tests;
+	uint32_t test = 0; //index of the test running now
+	uint32_t frame = 0; //frame within the test
+	uint32_t warmup_frames = 20; //(not timed)
+	uint32_t frames_per_test;
+
+	void print_results() const;
+
+	//----- opengl assets / helpers ------
+
+	//six-vertex paths:
+	typedef DrawVertex< true > TexturedVertex;
+	typedef DrawVertex< false > ColorVertex;
+
+	std::vector< TexturedVertex > textured_vertices;
+	std::vector< ColorVertex > color_vertices;
+	std::vector< RectProgram::Instance > rects;
+
+	//Shader programs for the two vertex types:
+	TexturedVertex::Program color_texture_program;
+	ColorVertex::Program color_program;
+
+	//Shader program that expands rectangle instances on the GPU:
+	RectProgram rect_program;
+
+	//Buffer used to hold vertex or instance data during drawing (a new region each frame):
+	StreamBuffer vertex_stream;
+
+	//Vertex Array Objects that map vertex_stream to color_texture_program and color_program attribute locations:
+	GLuint vertex_buffer_for_color_texture_program = 0;
+	GLuint vertex_buffer_for_color_program = 0;
+
+	//Vertex Array Object that maps vertex_stream to rect_program attribute locations (re-pointed each draw):
+	GLuint vertex_buffer_for_rect_program = 0;
+
+	//Solid white texture:
+	GLuint white_tex = 0;
+};
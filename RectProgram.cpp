@@ -0,0 +1,80 @@
+#include "RectProgram.hpp"
+
+#include "gl_compile_program.hpp"
+#include "gl_errors.hpp"
+
+RectProgram::RectProgram() {
+	//Compile vertex and fragment shaders using the convenient 'gl_compile_program' helper function:
+	program = gl_compile_program(
+		//vertex shader:
+		"#version 330\n"
+		"uniform mat4 OBJECT_TO_CLIP;\n"
+		"in vec2 Center;\n"
+		"in vec2 Radius;\n"
+		"in vec4 Color;\n"
+		"out vec4 color;\n"
+		"void main() {\n"
+		//corners of two CCW-oriented triangles, in the same order as the six-vertex rectangles the modes used to build:
+		"	const vec2 corners[6] = vec2[6](\n"
+		"		vec2(-1.0,-1.0), vec2( 1.0,-1.0), vec2( 1.0, 1.0),\n"
+		"		vec2(-1.0,-1.0), vec2( 1.0, 1.0), vec2(-1.0, 1.0)\n"
+		"	);\n"
+		"	gl_Position = OBJECT_TO_CLIP * vec4(Center + Radius * corners[gl_VertexID], 0.0, 1.0);\n"
+		"	color = Color;\n"
+		"}\n"
+	,
+		//fragment shader:
+		"#version 330\n"
+		"in vec4 color;\n"
+		"out vec4 fragColor;\n"
+		"void main() {\n"
+		"	fragColor = color;\n"
+		"}\n"
+	);
+
+	//look up the locations of vertex attributes:
+	Center_vec2 = glGetAttribLocation(program, "Center");
+	Radius_vec2 = glGetAttribLocation(program, "Radius");
+	Color_vec4 = glGetAttribLocation(program, "Color");
+
+	//look up the locations of uniforms:
+	OBJECT_TO_CLIP_mat4 = glGetUniformLocation(program, "OBJECT_TO_CLIP");
+}
+
+RectProgram::~RectProgram() {
+	glDeleteProgram(program);
+	program = 0;
+}
+
+void RectProgram::bind_instances(GLintptr offset) const {
+	glVertexAttribPointer(
+		Center_vec2, //attribute
+		2, //size
+		GL_FLOAT, //type
+		GL_FALSE, //normalized
+		sizeof(Instance), //stride
+		(GLbyte *)0 + offset + 0 //offset
+	);
+	glVertexAttribPointer(
+		Radius_vec2, //attribute
+		2, //size
+		GL_FLOAT, //type
+		GL_FALSE, //normalized
+		sizeof(Instance), //stride
+		(GLbyte *)0 + offset + 4*2 //offset
+	);
+	glVertexAttribPointer(
+		Color_vec4, //attribute
+		4, //size
+		GL_UNSIGNED_BYTE, //type
+		GL_TRUE, //normalized
+		sizeof(Instance), //stride
+		(GLbyte *)0 + offset + 4*2 + 4*2 //offset
+	);
+
+	//advance each attribute once per instance (not once per vertex):
+	for (GLuint attrib : {Center_vec2, Radius_vec2, Color_vec4}) {
+		glEnableVertexAttribArray(attrib);
+		glVertexAttribDivisor(attrib, 1);
+	}
+}
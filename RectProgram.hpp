@@ -0,0 +1,39 @@
+#pragma once
+
+#include "GL.hpp"
+
+#include <glm/glm.hpp>
+
+//Shader program that draws solid-colored rectangles, one instance per rectangle:
+// each instance's center, radius, and color are expanded into a quad (two triangles) on the GPU,
+// so a rectangle costs one 20-byte Instance instead of six vertices.
+struct RectProgram {
+	RectProgram();
+	~RectProgram();
+
+	GLuint program = 0;
+
+	//Attribute (per-instance variable) locations:
+	GLuint Center_vec2 = -1U;
+	GLuint Radius_vec2 = -1U;
+	GLuint Color_vec4 = -1U;
+
+	//Uniform (per-invocation variable) locations:
+	GLuint OBJECT_TO_CLIP_mat4 = -1U;
+
+	//per-instance data, laid out as the attributes expect it:
+	struct Instance {
+		Instance(glm::vec2 const &Center_, glm::vec2 const &Radius_, glm::u8vec4 const &Color_) :
+			Center(Center_), Radius(Radius_), Color(Color_) { }
+		glm::vec2 Center;
+		glm::vec2 Radius;
+		glm::u8vec4 Color;
+	};
+	static_assert(sizeof(Instance) == 4*2 + 4*2 + 1*4, "RectProgram::Instance should be packed");
+
+	//point the (bound) vertex array object's attributes at Instances starting 'offset' bytes into the buffer bound to GL_ARRAY_BUFFER:
+	// (GL 3.3 has no base instance for draws, so this is how a draw starts partway into a buffer)
+	void bind_instances(GLintptr offset) const;
+
+	//draw with: glDrawArraysInstanced(GL_TRIANGLES, 0, 6, count);
+};
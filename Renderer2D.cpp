@@ -0,0 +1,272 @@
+#include "Renderer2D.hpp"
+
+//for the GL_ERRORS() macro:
+#include "gl_errors.hpp"
+
+//for glm::value_ptr() :
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+std::unique_ptr< Renderer2D > Renderer2D::current;
+
+Renderer2D::Renderer2D() : stream(256 * 1024) {
+	//----- allocate OpenGL resources -----
+
+	//vertex arrays for each program (their attributes are pointed at a buffer in flush()):
+	glGenVertexArrays(1, &rect_vao);
+	glGenVertexArrays(1, &color_vao);
+	glGenVertexArrays(1, &texture_vao);
+
+	{ //solid white texture:
+		//ask OpenGL to fill white_tex with the name of an unused texture object:
+		glGenTextures(1, &white_tex);
+
+		//bind that texture object as a GL_TEXTURE_2D-type texture:
+		glBindTexture(GL_TEXTURE_2D, white_tex);
+
+		//upload a 1x1 image of solid white to the texture:
+		glm::u8vec4 white = glm::u8vec4(0xff, 0xff, 0xff, 0xff);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, &white);
+
+		//set filtering and wrapping parameters:
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+		//since texture uses a mipmap and we haven't uploaded one, instruct opengl to make one for us:
+		glGenerateMipmap(GL_TEXTURE_2D);
+
+		//Okay, texture uploaded, can unbind it:
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+}
+
+Renderer2D::~Renderer2D() {
+	//----- free OpenGL resources -----
+	glDeleteVertexArrays(1, &rect_vao);
+	rect_vao = 0;
+
+	glDeleteVertexArrays(1, &color_vao);
+	color_vao = 0;
+
+	glDeleteVertexArrays(1, &texture_vao);
+	texture_vao = 0;
+
+	glDeleteTextures(1, &white_tex);
+	white_tex = 0;
+}
+
+void Renderer2D::add_run(uint64_t key, GLuint buffer, uint32_t first, uint32_t count) {
+	if (count == 0) return;
+	//extend the last run if this continues it:
+	if (!frame_runs.empty()) {
+		Run &last = frame_runs.back();
+		if (last.key == key && last.buffer == buffer && last.first + last.count == first) {
+			last.count += count;
+			return;
+		}
+	}
+	frame_runs.push_back(Run{key, uint32_t(frame_runs.size()), buffer, first, count});
+	runs += 1;
+}
+
+void Renderer2D::rect(Key const &key, glm::vec2 const &center, glm::vec2 const &radius, glm::u8vec4 const &color) {
+	uint32_t first = uint32_t(rect_arena.size());
+	rect_arena.emplace_back(center, radius, color);
+	add_run(pack(key, Rects), 0, first, 1);
+}
+
+void Renderer2D::rects(Key const &key, RectProgram::Instance const *instances, uint32_t count) {
+	uint32_t first = uint32_t(rect_arena.size());
+	rect_arena.insert(rect_arena.end(), instances, instances + count);
+	add_run(pack(key, Rects), 0, first, count);
+}
+
+void Renderer2D::triangles(Key const &key, ColorVertex const *vertices, uint32_t vertex_count) {
+	uint32_t first = uint32_t(color_arena.size());
+	color_arena.insert(color_arena.end(), vertices, vertices + vertex_count);
+	add_run(pack(key, Colors), 0, first, vertex_count);
+}
+
+void Renderer2D::triangles(Key const &key, TextureVertex const *vertices, uint32_t vertex_count) {
+	uint32_t first = uint32_t(texture_arena.size());
+	texture_arena.insert(texture_arena.end(), vertices, vertices + vertex_count);
+	add_run(pack(key, Textured), 0, first, vertex_count);
+}
+
+void Renderer2D::retained_rects(Key const &key, RetainedBuffer const &buffer, uint32_t first, uint32_t count) {
+	add_run(pack(key, Rects), buffer.buffer, first, count);
+}
+
+void Renderer2D::flush(glm::mat4 const &object_to_clip) {
+	//---- sort ----
+
+	//key order, and submission order for equal keys:
+	std::sort(frame_runs.begin(), frame_runs.end(), [](Run const &a, Run const &b) {
+		return (a.key != b.key ? a.key < b.key : a.order < b.order);
+	});
+
+	//---- stream ----
+
+	//copy streamed shapes into 'staging' in draw order, one section per program:
+	size_t const sizes[3] = { sizeof(RectProgram::Instance), sizeof(ColorVertex), sizeof(TextureVertex) };
+	uint8_t const *arenas[3] = {
+		reinterpret_cast< uint8_t const * >(rect_arena.data()),
+		reinterpret_cast< uint8_t const * >(color_arena.data()),
+		reinterpret_cast< uint8_t const * >(texture_arena.data())
+	};
+
+	//each section starts at a multiple of its element size, so draws from it can start at a vertex index
+	// (and the whole write starts at a multiple of every element size, so that holds within the buffer too):
+	auto round_up = [](size_t at, size_t to) { return (at + to - 1) / to * to; };
+	size_t starts[3];
+	starts[Rects] = 0;
+	starts[Colors] = round_up(starts[Rects] + rect_arena.size() * sizes[Rects], sizes[Colors]);
+	starts[Textured] = round_up(starts[Colors] + color_arena.size() * sizes[Colors], sizes[Textured]);
+	staging.resize(starts[Textured] + texture_arena.size() * sizes[Textured]);
+
+	size_t at[3] = { starts[Rects], starts[Colors], starts[Textured] };
+	for (Run &run : frame_runs) {
+		if (run.buffer) continue;
+		Program program = program_of(run.key);
+		size_t size = sizes[program];
+		std::memcpy(staging.data() + at[program], arenas[program] + run.first * size, run.count * size);
+		run.first = uint32_t((at[program] - starts[program]) / size); //(now relative to the section)
+		at[program] += run.count * size;
+	}
+
+	constexpr GLsizeiptr Alignment = 48;
+	static_assert(Alignment % sizeof(ColorVertex) == 0 && Alignment % sizeof(TextureVertex) == 0, "stream alignment should suit every vertex size");
+	GLintptr offset = stream.write(staging.data(), staging.size(), Alignment);
+
+	//---- draw ----
+
+	//don't use the depth test:
+	glDisable(GL_DEPTH_TEST);
+
+	//current state (-1 / 0 for 'not set this frame'):
+	int current_program = -1;
+	int current_blend = -1;
+	GLuint current_texture = 0;
+	GLuint color_source = 0; //buffer color_vao reads from
+	GLuint texture_source = 0; //buffer texture_vao reads from
+
+	for (size_t r = 0; r < frame_runs.size(); ) {
+		Run const &run = frame_runs[r];
+
+		//merge following runs that continue this one with the same key:
+		// (streamed runs with the same key always do, since they were staged in draw order)
+		uint32_t count = run.count;
+		for (r += 1; r < frame_runs.size(); ++r) {
+			Run const &next = frame_runs[r];
+			if (next.key != run.key || next.buffer != run.buffer || next.first != run.first + count) break;
+			count += next.count;
+		}
+
+		Program program = program_of(run.key);
+		if (int(program) != current_program) {
+			current_program = int(program);
+			GLuint program_name = (program == Rects ? rect_program.program : program == Colors ? color_program.program : texture_program.program);
+			GLuint object_to_clip_location = (program == Rects ? rect_program.OBJECT_TO_CLIP_mat4 : program == Colors ? color_program.OBJECT_TO_CLIP_mat4 : texture_program.OBJECT_TO_CLIP_mat4);
+			glUseProgram(program_name);
+			glUniformMatrix4fv(object_to_clip_location, 1, GL_FALSE, glm::value_ptr(object_to_clip));
+			glBindVertexArray(program == Rects ? rect_vao : program == Colors ? color_vao : texture_vao);
+			state_changes += 1;
+		}
+
+		Blend blend = blend_of(run.key);
+		if (int(blend) != current_blend) {
+			current_blend = int(blend);
+			if (blend == Alpha) {
+				glEnable(GL_BLEND);
+				glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			} else {
+				glDisable(GL_BLEND);
+			}
+			state_changes += 1;
+		}
+
+		GLuint source = (run.buffer ? run.buffer : stream.buffer);
+		size_t base = (run.buffer ? 0 : offset + starts[program]); //byte offset of element zero in 'source'
+
+		if (program == Rects) {
+			//GL 3.3 has no base instance for draws, so every rectangle draw points the instance attributes at its first instance:
+			glBindBuffer(GL_ARRAY_BUFFER, source);
+			rect_program.bind_instances(GLintptr(base + run.first * sizes[Rects]));
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			state_changes += 1;
+
+			//run the OpenGL pipeline (six vertices per rectangle instance):
+			glDrawArraysInstanced(GL_TRIANGLES, 0, 6, GLsizei(count));
+		} else {
+			//point the vertex array at the source buffer, if it isn't already:
+			GLuint &vao_source = (program == Colors ? color_source : texture_source);
+			if (vao_source != source) {
+				vao_source = source;
+				glBindBuffer(GL_ARRAY_BUFFER, source);
+				if (program == Colors) ColorVertex::bind_attributes(color_program);
+				else TextureVertex::bind_attributes(texture_program);
+				glBindBuffer(GL_ARRAY_BUFFER, 0);
+				state_changes += 1;
+			}
+
+			if (program == Textured) {
+				GLuint texture = (texture_of(run.key) ? texture_of(run.key) : white_tex);
+				if (texture != current_texture) {
+					current_texture = texture;
+					glActiveTexture(GL_TEXTURE0);
+					glBindTexture(GL_TEXTURE_2D, texture);
+					state_changes += 1;
+				}
+			}
+
+			//run the OpenGL pipeline:
+			glDrawArrays(GL_TRIANGLES, GLint(base / sizes[program] + run.first), GLsizei(count));
+		}
+		draws += 1;
+	}
+
+	//(this frame's region can be reused once the GPU is done with the draws above)
+	stream.end_frame();
+
+	if (current_texture) {
+		//unbind the texture:
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	//reset vertex array to none:
+	glBindVertexArray(0);
+
+	//reset current program to none:
+	glUseProgram(0);
+
+	GL_ERRORS(); //PARANOIA: print errors just in case we did something wrong.
+
+	//---- ready for the next frame ----
+	frame_runs.clear();
+	rect_arena.clear();
+	color_arena.clear();
+	texture_arena.clear();
+	frames += 1;
+}
+
+size_t Renderer2D::arena_bytes() const {
+	return frame_runs.capacity() * sizeof(Run)
+	     + rect_arena.capacity() * sizeof(RectProgram::Instance)
+	     + color_arena.capacity() * sizeof(ColorVertex)
+	     + texture_arena.capacity() * sizeof(TextureVertex);
+}
+
+std::string Renderer2D::report() const {
+	std::ostringstream out;
+	double per_frame = (frames ? 1.0 / double(frames) : 0.0);
+	out << frames << " frames, " << runs * per_frame << " submissions, " << draws * per_frame << " draws, and "
+	    << state_changes * per_frame << " state changes per frame";
+	return out.str();
+}
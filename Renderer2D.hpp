@@ -0,0 +1,143 @@
+#pragma once
+
+#include "RectProgram.hpp"
+#include "DrawVertex.hpp"
+#include "StreamBuffer.hpp"
+#include "RetainedBuffer.hpp"
+#include "GL.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * Renderer2D draws every mode's 2D shapes. There is one per OpenGL context.
+ *  It owns the shader programs, their vertex array objects, the vertex stream
+ *  and the solid white texture, so switching modes creates no GL objects.
+ *
+ * Modes submit rectangles and triangles during draw(), each tagged with a
+ *  Key, and then call flush(). flush() sorts what was submitted by key: layer
+ *  first, then program, texture and blend state. Shapes are only reordered
+ *  within a layer, and only to group ones that share state; shapes with the
+ *  same key stay in submission order. Neighbors with the same key become one
+ *  draw call. All streamed data goes out in one write, and GL state is only
+ *  changed when the next draw needs something different.
+ *
+ * Usage, in a mode's draw():
+ *   Renderer2D &renderer = *Renderer2D::current;
+ *   renderer.rect(Layer, center, radius, color); //(and/or triangles(), retained_rects(), ...)
+ *   renderer.flush(object_to_clip);
+ */
+
+struct Renderer2D {
+	Renderer2D();
+	~Renderer2D();
+
+	//the renderer for the current OpenGL context (created by main() right after the context, and destroyed before it):
+	static std::unique_ptr< Renderer2D > current;
+
+	//vertex formats for triangles (see DrawVertex.hpp):
+	typedef DrawVertex< false > ColorVertex;
+	typedef DrawVertex< true > TextureVertex;
+
+	//----- sort keys -----
+
+	enum Blend : uint8_t {
+		Alpha, //blended with (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA)
+		Opaque, //no blending
+	};
+
+	//what a submission is drawn with (its program comes from the kind of shape submitted):
+	struct Key {
+		Key(uint8_t layer_ = 0, GLuint texture_ = 0, Blend blend_ = Alpha) : layer(layer_), texture(texture_), blend(blend_) { }
+		uint8_t layer; //higher layers draw on top of lower ones
+		GLuint texture; //TextureVertex triangles sample this (or the white texture if 0); ignored otherwise
+		Blend blend;
+	};
+
+	//----- submission (draw order within a layer is up to the renderer) -----
+
+	void rect(Key const &key, glm::vec2 const &center, glm::vec2 const &radius, glm::u8vec4 const &color);
+	void rects(Key const &key, RectProgram::Instance const *instances, uint32_t count);
+	void triangles(Key const &key, ColorVertex const *vertices, uint32_t vertex_count);
+	void triangles(Key const &key, TextureVertex const *vertices, uint32_t vertex_count);
+
+	//draw 'count' rectangles / vertices from a retained buffer, starting with the 'first'th:
+	// (the buffer must hold the data until flush())
+	void retained_rects(Key const &key, RetainedBuffer const &buffer, uint32_t first, uint32_t count);
+	template< typename Vertex >
+	void retained_triangles(Key const &key, RetainedBuffer const &buffer, uint32_t first, uint32_t vertex_count) {
+		add_run(pack(key, Vertex::Textured ? Textured : Colors), buffer.buffer, first, vertex_count);
+	}
+
+	//draw everything submitted since the last flush(), transformed by 'object_to_clip':
+	void flush(glm::mat4 const &object_to_clip);
+
+	//bytes reserved by the submission arenas (these keep their high-water capacity, so once
+	// a mode's frames stop growing, submitting doesn't allocate):
+	size_t arena_bytes() const;
+
+	//----- statistics -----
+	uint64_t frames = 0; //calls to flush()
+	uint64_t runs = 0; //submissions (after merging back-to-back ones with the same key)
+	uint64_t draws = 0; //draw calls issued
+	uint64_t state_changes = 0; //program, texture, blend, and vertex source changes
+
+	//one-line summary: draws and state changes per frame:
+	std::string report() const;
+
+	//----- internals -----
+
+	enum Program : uint8_t {
+		Rects, //RectProgram instances
+		Colors, //ColorProgram triangles
+		Textured, //ColorTextureProgram triangles
+	};
+
+	//sort key: layer, then program, blend, and texture, packed so they compare in that order:
+	static uint64_t pack(Key const &key, Program program) {
+		return (uint64_t(key.layer) << 56) | (uint64_t(program) << 48) | (uint64_t(key.blend) << 40)
+		     | uint64_t(program == Textured ? key.texture : 0);
+	}
+	static Program program_of(uint64_t packed) { return Program((packed >> 48) & 0xff); }
+	static Blend blend_of(uint64_t packed) { return Blend((packed >> 40) & 0xff); }
+	static GLuint texture_of(uint64_t packed) { return GLuint(packed & 0xffffffff); }
+
+	//a run of shapes with one key, all from one place:
+	struct Run {
+		uint64_t key;
+		uint32_t order; //(submission order, for sorting equal keys)
+		GLuint buffer; //0 if the shapes are in the arena for its program (and get streamed), else a retained buffer
+		uint32_t first; //first instance / vertex in the arena or buffer
+		uint32_t count;
+	};
+	std::vector< Run > frame_runs;
+
+	//submitted shapes, by program:
+	std::vector< RectProgram::Instance > rect_arena;
+	std::vector< ColorVertex > color_arena;
+	std::vector< TextureVertex > texture_arena;
+
+	//this frame's streamed shapes in draw order, ready for one write to 'stream':
+	std::vector< uint8_t > staging;
+
+	void add_run(uint64_t key, GLuint buffer, uint32_t first, uint32_t count);
+
+	RectProgram rect_program;
+	ColorProgram color_program;
+	ColorTextureProgram texture_program;
+
+	//Buffer used to hold streamed shapes during drawing (a new region each frame):
+	StreamBuffer stream;
+
+	//Vertex Array Objects for each program (their attributes are pointed at a buffer as needed):
+	GLuint rect_vao = 0;
+	GLuint color_vao = 0;
+	GLuint texture_vao = 0;
+
+	//Solid white texture (for TextureVertex triangles with no texture):
+	GLuint white_tex = 0;
+};
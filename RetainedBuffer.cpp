@@ -0,0 +1,35 @@
+#include "RetainedBuffer.hpp"
+
+//for the GL_ERRORS() macro:
+#include "gl_errors.hpp"
+
+#include <sstream>
+
+RetainedBuffer::RetainedBuffer(GLenum usage_) : usage(usage_) {
+	glGenBuffers(1, &buffer);
+}
+
+RetainedBuffer::~RetainedBuffer() {
+	glDeleteBuffers(1, &buffer);
+	buffer = 0;
+}
+
+void RetainedBuffer::upload(void const *data, GLsizeiptr size_) {
+	//(respecifying the whole buffer lets the driver hand back fresh storage
+	// rather than wait for draws still reading the old contents)
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glBufferData(GL_ARRAY_BUFFER, size_, data, usage);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	size = size_;
+	rebuilds += 1;
+	bytes += uint64_t(size_);
+
+	GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+}
+
+std::string RetainedBuffer::report() const {
+	std::ostringstream out;
+	out << rebuilds << " rebuilds, " << bytes << " bytes uploaded";
+	return out.str();
+}
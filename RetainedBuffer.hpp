@@ -0,0 +1,39 @@
+#pragma once
+
+#include "GL.hpp"
+
+#include <cstdint>
+#include <string>
+
+/*
+ * RetainedBuffer is a vertex buffer for data that rarely changes (the court's
+ *  walls, a HUD): the owner rebuilds its contents only when they are out of
+ *  date and uploads them here, and every frame in between draws straight
+ *  from the buffer without touching it.
+ *
+ * (Data that changes every frame goes through a StreamBuffer instead.)
+ *
+ * Usage:
+ *   if (layer is out of date) { rebuild 'instances'; retained.upload(instances.data(), bytes); }
+ *   glDrawArrays(...); //(with retained.buffer bound in the VAO)
+ */
+
+struct RetainedBuffer {
+	//'usage' is a hint: GL_STATIC_DRAW for data rebuilt about never, GL_DYNAMIC_DRAW for data rebuilt now and then:
+	RetainedBuffer(GLenum usage = GL_STATIC_DRAW);
+	~RetainedBuffer();
+
+	//replace the contents with 'size' bytes from 'data':
+	void upload(void const *data, GLsizeiptr size);
+
+	GLuint buffer = 0;
+	GLenum usage = GL_STATIC_DRAW;
+	GLsizeiptr size = 0; //bytes in the buffer
+
+	//----- statistics -----
+	uint64_t rebuilds = 0; //calls to upload()
+	uint64_t bytes = 0; //total uploaded
+
+	//one-line summary: rebuilds and bytes uploaded:
+	std::string report() const;
+};
@@ -0,0 +1,72 @@
+#include "RowGenerator.hpp"
+
+#include <chrono>
+#include <algorithm>
+#include <cassert>
+
+RowGenerator::RowGenerator(uint32_t seed, uint32_t capacity, uint32_t chunk_) : worker_waits(0), head(0), tail(0), rng(seed, 2), quit(false) {
+	uint32_t size = 1;
+	while (size < capacity) size *= 2;
+	ring.assign(size, Row{0, 0});
+	mask = size - 1;
+	chunk = std::max(1u, std::min(chunk_, size));
+
+	//start full, so the first rows never wait on the worker:
+	fill(size);
+
+	worker = std::thread(&RowGenerator::work, this);
+}
+
+RowGenerator::~RowGenerator() {
+	{
+		std::lock_guard< std::mutex > lock(quit_mutex);
+		quit.store(true, std::memory_order_relaxed);
+	}
+	quit_cv.notify_one();
+	worker.join();
+}
+
+void RowGenerator::fill(uint32_t count) {
+	uint32_t t = tail.load(std::memory_order_relaxed);
+	for (uint32_t i = 0; i < count; ++i) {
+		Row &row = ring[(t + i) & mask];
+		row.count_draw = rng();
+		row.lane_draw = rng();
+	}
+	tail.store(t + count, std::memory_order_release);
+}
+
+void RowGenerator::work() {
+	while (!quit.load(std::memory_order_relaxed)) {
+		uint32_t ready = tail.load(std::memory_order_relaxed) - head.load(std::memory_order_acquire);
+		if (uint32_t(ring.size()) - ready < chunk) {
+			//(rows are used a few times a second in play, so there is no hurry)
+			worker_waits.fetch_add(1, std::memory_order_relaxed);
+			std::unique_lock< std::mutex > lock(quit_mutex);
+			quit_cv.wait_for(lock, std::chrono::milliseconds(1), [this](){ return quit.load(std::memory_order_relaxed); });
+			continue;
+		}
+		fill(chunk);
+	}
+}
+
+RowGenerator::Row RowGenerator::pop() {
+	uint32_t h = head.load(std::memory_order_relaxed);
+	uint32_t t = tail.load(std::memory_order_acquire);
+	if (t == h) {
+		stalls += 1;
+		do {
+			std::this_thread::yield();
+			t = tail.load(std::memory_order_acquire);
+		} while (t == h);
+	}
+	assert(t - h <= ring.size());
+
+	pops += 1;
+	depth_total += t - h;
+	min_depth = std::min(min_depth, t - h);
+
+	Row row = ring[h & mask];
+	head.store(h + 1, std::memory_order_release);
+	return row;
+}
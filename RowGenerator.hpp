@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Pcg32.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+/*
+ * RowGenerator makes the random draws for TankSim's enemy rows ahead of
+ *  time, on a worker thread, so the update thread only has to pop them.
+ *
+ * Rows are passed through a fixed-capacity single-producer/single-consumer
+ *  ring: the worker refills it a chunk at a time and sleeps while it is
+ *  full; pop() takes one row, and spins (counting a stall) only if the
+ *  worker has fallen behind.
+ *
+ * The rows depend only on the seed (the worker owns its generator), so a
+ *  game fed by a RowGenerator plays out the same however the threads are
+ *  scheduled. They are not the same rows as TankSim's own generator makes.
+ */
+
+struct RowGenerator {
+	//how much of a row is raw randomness; TankSim scales these into the row's enemy count and lane:
+	struct Row {
+		uint32_t count_draw;
+		uint32_t lane_draw;
+	};
+
+	//capacity is rounded up to a power of two; the ring starts full:
+	explicit RowGenerator(uint32_t seed, uint32_t capacity = 1024, uint32_t chunk = 64);
+	~RowGenerator();
+
+	//take the next row (only call from one thread):
+	Row pop();
+
+	//----- stats (kept by pop()) -----
+	uint64_t pops = 0;
+	uint64_t stalls = 0; //pops that found the ring empty and had to wait for the worker
+	uint64_t depth_total = 0; //rows ready at each pop, summed
+	uint32_t min_depth = ~0U; //fewest rows ready at any pop
+	double mean_depth() const { return pops ? double(depth_total) / pops : 0.0; }
+	std::atomic< uint64_t > worker_waits; //times the worker found the ring full and slept
+
+	//----- ring -----
+	std::vector< Row > ring;
+	uint32_t mask = 0; //ring.size() - 1
+	uint32_t chunk = 0; //rows the worker writes per refill
+	//(head is only written by pop(), tail only by the worker; padding keeps them on separate cache lines)
+	std::atomic< uint32_t > head;
+	uint8_t head_padding[60];
+	std::atomic< uint32_t > tail;
+	uint8_t tail_padding[60];
+
+	//----- worker -----
+	Pcg32 rng; //(only touched by the worker once it starts)
+	std::atomic< bool > quit;
+	std::mutex quit_mutex; //(only used so the destructor can wake a sleeping worker; the ring is lock-free)
+	std::condition_variable quit_cv;
+	std::thread worker;
+	void fill(uint32_t count); //write 'count' rows after tail and publish them
+	void work();
+};
@@ -0,0 +1,109 @@
+#include "StreamBuffer.hpp"
+
+//for the GL_ERRORS() macro:
+#include "gl_errors.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+
+StreamBuffer::StreamBuffer(GLsizeiptr region_size_) {
+	glGenBuffers(1, &buffer);
+	grow(std::max< GLsizeiptr >(region_size_, 1));
+	growths = 0; //(the first allocation doesn't count)
+}
+
+StreamBuffer::~StreamBuffer() {
+	for (GLsync &fence : fences) {
+		if (fence) glDeleteSync(fence);
+		fence = nullptr;
+	}
+	glDeleteBuffers(1, &buffer);
+	buffer = 0;
+}
+
+void StreamBuffer::grow(GLsizeiptr needed) {
+	region_size = std::max(region_size, 2 * needed);
+	//(fresh storage: nothing is reading it yet, so old fences don't matter)
+	for (GLsync &fence : fences) {
+		if (fence) glDeleteSync(fence);
+		fence = nullptr;
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glBufferData(GL_ARRAY_BUFFER, Regions * region_size, nullptr, GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	used = 0;
+	growths += 1;
+
+	GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
+}
+
+GLintptr StreamBuffer::write(void const *data, GLsizeiptr size, GLsizeiptr alignment) {
+	//offsets are aligned relative to the start of the buffer (so they can be divided by a vertex size):
+	auto aligned = [alignment](GLsizeiptr at) { return (at + alignment - 1) / alignment * alignment; };
+
+	GLsizeiptr base = region * region_size;
+	GLsizeiptr start = aligned(base + used) - base;
+	if (start + size > region_size) {
+		grow(start + size);
+		base = region * region_size;
+		start = aligned(base) - base;
+		waited = true; //(new storage, nothing to wait for)
+	}
+
+	//before first touching this region this frame, wait until the GPU is done with what was drawn from it last time:
+	if (!waited) {
+		waited = true;
+		if (fences[region]) {
+			auto before = std::chrono::high_resolution_clock::now();
+			GLbitfield flags = 0;
+			while (true) {
+				GLenum result = glClientWaitSync(fences[region], flags, 1000000); //(1 ms)
+				if (result != GL_TIMEOUT_EXPIRED) break; //(GL_WAIT_FAILED means the context is gone; nothing left to wait for)
+				flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+			}
+			frame_stall_seconds += std::chrono::duration< double >(std::chrono::high_resolution_clock::now() - before).count();
+			glDeleteSync(fences[region]);
+			fences[region] = nullptr;
+		}
+	}
+
+	if (size > 0) {
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		void *to = glMapBufferRange(GL_ARRAY_BUFFER, base + start, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+		if (to) {
+			std::memcpy(to, data, size);
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	used = start + size;
+	bytes += uint64_t(size);
+	return base + start;
+}
+
+void StreamBuffer::end_frame() {
+	if (used > 0) {
+		if (fences[region]) glDeleteSync(fences[region]);
+		fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+	region = (region + 1) % Regions;
+	used = 0;
+	waited = false;
+
+	frames += 1;
+	stall_seconds += frame_stall_seconds;
+	worst_stall_seconds = std::max(worst_stall_seconds, frame_stall_seconds);
+	frame_stall_seconds = 0.0;
+}
+
+std::string StreamBuffer::report() const {
+	std::ostringstream out;
+	double per_frame = (frames ? 1.0 / double(frames) : 0.0);
+	out << frames << " frames, " << uint64_t(bytes * per_frame) << " bytes streamed per frame, "
+	    << stall_seconds * per_frame * 1e3 << " ms stalled per frame (worst " << worst_stall_seconds * 1e3 << " ms), "
+	    << Regions << " x " << region_size << " byte regions (grew " << growths << " times)";
+	return out.str();
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "GL.hpp"
+
+#include <cstdint>
+#include <string>
+
+/*
+ * StreamBuffer is a vertex buffer for data that is rewritten every frame.
+ *
+ * One buffer allocation is split into three regions used in turn, one per
+ *  frame. Each frame's data is written straight into its region with
+ *  glMapBufferRange (unsynchronized, invalidating only that range), and a
+ *  fence is placed after the frame's draws; before a region is reused, the
+ *  fence from three frames ago is waited on, so the GPU is never still
+ *  reading what gets overwritten and the driver never has to reallocate.
+ *
+ * If a frame needs more room than a region has, the regions grow (to twice
+ *  what was needed) and the buffer is reallocated; the old storage stays
+ *  alive for draws already issued from it, so data written earlier in the
+ *  same frame must have been drawn already.
+ *
+ * Usage, each frame:
+ *   GLintptr offset = stream.write(vertices.data(), bytes, sizeof(Vertex));
+ *   glDrawArrays(..., GLint(offset / sizeof(Vertex)), count); //(with stream.buffer bound in the VAO)
+ *   stream.end_frame();
+ */
+
+struct StreamBuffer {
+	StreamBuffer(GLsizeiptr region_size = 64 * 1024);
+	~StreamBuffer();
+
+	//copy 'size' bytes into this frame's region, starting at a multiple of 'alignment' bytes from the start of the buffer:
+	// returns the byte offset of the data in 'buffer'.
+	GLintptr write(void const *data, GLsizeiptr size, GLsizeiptr alignment = 1);
+
+	//call after the draws that use this frame's writes:
+	void end_frame();
+
+	GLuint buffer = 0;
+
+	static constexpr uint32_t Regions = 3;
+	GLsizeiptr region_size = 0;
+	uint32_t region = 0; //region this frame writes to
+	GLsizeiptr used = 0; //bytes of it used so far this frame
+	bool waited = false; //has this frame waited for its region yet?
+	GLsync fences[Regions] = { nullptr, nullptr, nullptr };
+
+	//----- statistics -----
+	uint64_t frames = 0;
+	uint64_t bytes = 0; //total written
+	uint64_t growths = 0;
+	double stall_seconds = 0.0; //total time spent waiting on fences
+	double worst_stall_seconds = 0.0; //(longest wait in one frame)
+	double frame_stall_seconds = 0.0; //(wait so far this frame)
+
+	//one-line summary: bytes streamed and stall time per frame, region size, growths:
+	std::string report() const;
+
+	void grow(GLsizeiptr needed);
+};
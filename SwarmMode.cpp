@@ -0,0 +1,113 @@
+#include "SwarmMode.hpp"
+
+#include <algorithm>
+
+SwarmMode::SwarmMode(uint32_t enemy_count, uint32_t max_bullets, uint32_t seed) : sim(enemy_count, max_bullets, glm::vec2(40.0f, 30.0f), seed) {
+}
+
+bool SwarmMode::handle_event(SDL_Event const &evt, glm::uvec2 const &window_size) {
+	if (evt.type == SDL_KEYDOWN || evt.type == SDL_KEYUP) {
+		bool down = (evt.type == SDL_KEYDOWN);
+		auto key = evt.key.keysym.sym;
+		if (key == SDLK_a || key == SDLK_LEFT) {
+			left_held = down;
+		} else if (key == SDLK_d || key == SDLK_RIGHT) {
+			right_held = down;
+		} else if (key == SDLK_SPACE) {
+			sim.firing = down;
+		}
+	}
+	if ((evt.type == SDL_MOUSEBUTTONDOWN || evt.type == SDL_MOUSEBUTTONUP) && evt.button.button == SDL_BUTTON_LEFT) {
+		sim.firing = (evt.type == SDL_MOUSEBUTTONDOWN);
+	}
+	sim.player_move = (right_held ? 1.0f : 0.0f) - (left_held ? 1.0f : 0.0f);
+
+	return false;
+}
+
+void SwarmMode::update(float elapsed) {
+	sim.update(elapsed);
+}
+
+std::string SwarmMode::status() const {
+	return std::to_string(sim.enemies_shot) + " enemies shot, player at " + std::to_string(sim.player.x);
+}
+
+void SwarmMode::draw(glm::uvec2 const &drawable_size, float alpha) {
+	//some nice colors from the course web page:
+	#define HEX_TO_U8VEC4( HX ) (glm::u8vec4( (HX >> 24) & 0xff, (HX >> 16) & 0xff, (HX >> 8) & 0xff, (HX) & 0xff ))
+	const glm::u8vec4 bg_color = HEX_TO_U8VEC4(0x193b59ff);
+	const glm::u8vec4 fg_color = HEX_TO_U8VEC4(0xf2d2b6ff);
+	const glm::u8vec4 bullet_color = HEX_TO_U8VEC4(0xf2ad94ff);
+	const glm::u8vec4 player_color = HEX_TO_U8VEC4(0x6d704fff);
+	#undef HEX_TO_U8VEC4
+
+	//other useful drawing constants:
+	const float wall_radius = 0.1f;
+	const float padding = 0.3f; //padding between outside of walls and edge of window
+
+	glm::vec2 const &court_radius = sim.court_radius;
+
+	//---- submit rectangles ----
+
+	Renderer2D &renderer = *Renderer2D::current;
+
+	//inline helper function for rectangle drawing:
+	auto draw_rectangle = [&renderer](glm::vec2 const &center, glm::vec2 const &radius, glm::u8vec4 const &color) {
+		//(everything is in one layer, so it draws in the order submitted)
+		renderer.rect(0, center, radius, color);
+	};
+
+	//walls:
+	draw_rectangle(glm::vec2(-court_radius.x-wall_radius, 0.0f), glm::vec2(wall_radius, court_radius.y + 2.0f * wall_radius), fg_color);
+	draw_rectangle(glm::vec2( court_radius.x+wall_radius, 0.0f), glm::vec2(wall_radius, court_radius.y + 2.0f * wall_radius), fg_color);
+	draw_rectangle(glm::vec2( 0.0f,-court_radius.y-wall_radius), glm::vec2(court_radius.x, wall_radius), fg_color);
+	draw_rectangle(glm::vec2( 0.0f, court_radius.y+wall_radius), glm::vec2(court_radius.x, wall_radius), fg_color);
+
+	//enemies and bullets:
+	for (uint32_t i = 0; i < sim.enemy_count; ++i) {
+		draw_rectangle(glm::vec2(sim.enemy_x[i], sim.enemy_y[i]), sim.enemy_radius, fg_color);
+	}
+	for (uint32_t i = 0; i < sim.bullet_count; ++i) {
+		draw_rectangle(glm::vec2(sim.bullet_x[i], sim.bullet_y[i]), sim.bullet_radius, bullet_color);
+	}
+
+	//player:
+	draw_rectangle(sim.player, sim.player_radius, player_color);
+
+	//------ compute court-to-window transform ------
+
+	//compute area that should be visible:
+	glm::vec2 scene_min = -court_radius - glm::vec2(2.0f * wall_radius + padding);
+	glm::vec2 scene_max = court_radius + glm::vec2(2.0f * wall_radius + padding);
+
+	//compute window aspect ratio:
+	float aspect = drawable_size.x / float(drawable_size.y);
+	//we'll scale the x coordinate by 1.0 / aspect to make sure things stay square.
+
+	//compute scale factor for court given that...
+	float scale = std::min(
+		(2.0f * aspect) / (scene_max.x - scene_min.x), //... x must fit in [-aspect,aspect] ...
+		(2.0f) / (scene_max.y - scene_min.y) //... y must fit in [-1,1].
+	);
+
+	glm::vec2 center = 0.5f * (scene_max + scene_min);
+
+	//build matrix that scales and translates appropriately:
+	glm::mat4 court_to_clip = glm::mat4(
+		glm::vec4(scale / aspect, 0.0f, 0.0f, 0.0f),
+		glm::vec4(0.0f, scale, 0.0f, 0.0f),
+		glm::vec4(0.0f, 0.0f, 1.0f, 0.0f),
+		glm::vec4(-center.x * (scale / aspect), -center.y * scale, 0.0f, 1.0f)
+	);
+	//NOTE: glm matrices are specified in *Column-Major* order,
+	// so each line above is specifying a *column* of the matrix(!)
+
+	//---- actual drawing ----
+
+	//clear the color buffer:
+	glClearColor(bg_color.r / 255.0f, bg_color.g / 255.0f, bg_color.b / 255.0f, bg_color.a / 255.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	renderer.flush(court_to_clip);
+}
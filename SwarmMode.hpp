@@ -0,0 +1,29 @@
+#include "Renderer2D.hpp"
+#include "SwarmSim.hpp"
+
+#include "Mode.hpp"
+#include "GL.hpp"
+
+#include <glm/glm.hpp>
+
+/*
+ * SwarmMode plays SwarmSim: a free-moving swarm of enemies to shoot at.
+ */
+
+struct SwarmMode : Mode {
+	SwarmMode(uint32_t enemy_count = 20000, uint32_t max_bullets = 2000, uint32_t seed = 0);
+
+	//functions called by main loop:
+	virtual bool handle_event(SDL_Event const &, glm::uvec2 const &window_size) override;
+	virtual void update(float elapsed) override;
+	virtual void draw(glm::uvec2 const &drawable_size, float alpha) override;
+	virtual std::string status() const override;
+
+	//----- game state -----
+	SwarmSim sim;
+
+	bool left_held = false;
+	bool right_held = false;
+
+	//(everything is drawn as solid rectangles through Renderer2D)
+};
@@ -0,0 +1,248 @@
+#include "SwarmSim.hpp"
+
+#include "aabb_overlap.hpp"
+#include "bits.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cassert>
+
+//seconds since an arbitrary point, for phase timings:
+static double now() {
+	return std::chrono::duration< double >(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+}
+
+SwarmSim::SwarmSim(uint32_t enemy_count_, uint32_t max_bullets_, glm::vec2 const &court_radius_, uint32_t seed) :
+	court_radius(court_radius_), enemy_count(enemy_count_), max_bullets(max_bullets_), rng(seed) {
+
+	player = glm::vec2(0.0f, -court_radius.y + player_radius.y);
+
+	//size cells so that there are about four enemies in each, but never smaller than an enemy:
+	float area = 4.0f * court_radius.x * court_radius.y;
+	cell_size = std::sqrt(area * 4.0f / std::max(1u, enemy_count));
+	cell_size = std::max(cell_size, 2.0f * std::max(enemy_radius.x, enemy_radius.y));
+	grid_w = std::max(1u, uint32_t(std::ceil(2.0f * court_radius.x / cell_size)));
+	grid_h = std::max(1u, uint32_t(std::ceil(2.0f * court_radius.y / cell_size)));
+	inv_cell_size = 1.0f / cell_size;
+	grid_max = glm::vec2(float(grid_w - 1), float(grid_h - 1));
+
+	//all storage is allocated up front; update() never allocates:
+	enemy_x.resize(enemy_count); enemy_y.resize(enemy_count);
+	enemy_vx.resize(enemy_count); enemy_vy.resize(enemy_count);
+	enemy_rx.assign(enemy_count, enemy_radius.x); enemy_ry.assign(enemy_count, enemy_radius.y);
+	enemy_dead.assign(enemy_count, 0);
+	shot.reserve(max_bullets);
+
+	bullet_x.resize(max_bullets); bullet_y.resize(max_bullets);
+	bullet_vx.resize(max_bullets); bullet_vy.resize(max_bullets);
+
+	cell_start.assign(grid_w * grid_h + 1, 0);
+	cell_cursor.assign(grid_w * grid_h, 0);
+	enemy_cell.resize(enemy_count);
+	sort_x.resize(enemy_count); sort_y.resize(enemy_count);
+	sort_vx.resize(enemy_count); sort_vy.resize(enemy_count);
+	hit_words.resize(aabb_mask_words(enemy_count));
+
+	//scatter enemies over the whole court to start:
+	std::uniform_real_distribution< float > y_dist(-court_radius.y, court_radius.y);
+	for (uint32_t i = 0; i < enemy_count; ++i) {
+		respawn_enemy(i);
+		enemy_y[i] = y_dist(rng);
+	}
+	count_cells();
+	rebuild_grid();
+}
+
+void SwarmSim::respawn_enemy(uint32_t i) {
+	std::uniform_real_distribution< float > x_dist(-court_radius.x + enemy_radius.x, court_radius.x - enemy_radius.x);
+	std::uniform_real_distribution< float > vx_dist(-1.0f, 1.0f);
+	std::uniform_real_distribution< float > vy_dist(-2.0f, -0.5f);
+	enemy_x[i] = x_dist(rng);
+	enemy_y[i] = court_radius.y;
+	enemy_vx[i] = vx_dist(rng);
+	enemy_vy[i] = vy_dist(rng);
+}
+
+uint32_t SwarmSim::cell_of(float x, float y) const {
+	//clamp in floating point first, so truncation is the same as floor:
+	// (this is called for every enemy every tick, so it avoids floor() and division)
+	float fx = std::max(0.0f, std::min(grid_max.x, (x + court_radius.x) * inv_cell_size));
+	float fy = std::max(0.0f, std::min(grid_max.y, (y + court_radius.y) * inv_cell_size));
+	return uint32_t(fy) * grid_w + uint32_t(fx);
+}
+
+void SwarmSim::update(float elapsed) {
+	double t0 = now();
+	move(elapsed);
+	double t1 = now();
+	rebuild_grid();
+	double t2 = now();
+	collide();
+	double t3 = now();
+	cleanup();
+	double t4 = now();
+
+	timings.move = t1 - t0;
+	timings.grid = t2 - t1;
+	timings.collide = t3 - t2;
+	timings.cleanup = t4 - t3;
+}
+
+void SwarmSim::move(float elapsed) {
+	//player:
+	player.x += std::max(-1.0f, std::min(1.0f, player_move)) * player_speed * elapsed;
+	player.x = std::max(player.x, -court_radius.x + player_radius.x);
+	player.x = std::min(player.x, court_radius.x - player_radius.x);
+
+	//enemies drift down, bounce off the side walls, and wrap from bottom to top:
+	//(each enemy's new grid cell is counted here while its position is at hand; see rebuild_grid)
+	std::fill(cell_start.begin(), cell_start.end(), 0);
+	float min_x = -court_radius.x + enemy_radius.x;
+	float max_x = court_radius.x - enemy_radius.x;
+	for (uint32_t i = 0; i < enemy_count; ++i) {
+		float x = enemy_x[i] + enemy_vx[i] * elapsed;
+		float y = enemy_y[i] + enemy_vy[i] * elapsed;
+		if (x < min_x) { x = min_x; enemy_vx[i] = std::abs(enemy_vx[i]); }
+		if (x > max_x) { x = max_x; enemy_vx[i] = -std::abs(enemy_vx[i]); }
+		if (y < -court_radius.y) y += 2.0f * court_radius.y;
+		enemy_x[i] = x;
+		enemy_y[i] = y;
+
+		uint32_t c = cell_of(x, y);
+		enemy_cell[i] = c;
+		cell_start[c + 1] += 1;
+	}
+
+	//bullets fly until they leave the court:
+	for (uint32_t i = 0; i < bullet_count; /* later */) {
+		bullet_x[i] += bullet_vx[i] * elapsed;
+		bullet_y[i] += bullet_vy[i] * elapsed;
+		if (bullet_y[i] > court_radius.y || std::abs(bullet_x[i]) > court_radius.x) {
+			bullet_count -= 1;
+			bullet_x[i] = bullet_x[bullet_count]; bullet_y[i] = bullet_y[bullet_count];
+			bullet_vx[i] = bullet_vx[bullet_count]; bullet_vy[i] = bullet_vy[bullet_count];
+		} else {
+			++i;
+		}
+	}
+
+	//fire new bullets in a spread from the player:
+	if (firing) {
+		fire_accumulator += fire_rate * elapsed;
+		std::uniform_real_distribution< float > spread_dist(-bullet_spread, bullet_spread);
+		while (fire_accumulator >= 1.0f && bullet_count < max_bullets) {
+			fire_accumulator -= 1.0f;
+			uint32_t b = bullet_count++;
+			bullet_x[b] = player.x;
+			bullet_y[b] = player.y + player_radius.y;
+			bullet_vx[b] = spread_dist(rng) * bullet_speed;
+			bullet_vy[b] = bullet_speed;
+		}
+		//(don't bank shots while the pool is full)
+		fire_accumulator = std::min(fire_accumulator, 1.0f);
+	} else {
+		fire_accumulator = 0.0f;
+	}
+}
+
+void SwarmSim::count_cells() {
+	std::fill(cell_start.begin(), cell_start.end(), 0);
+	for (uint32_t i = 0; i < enemy_count; ++i) {
+		uint32_t c = cell_of(enemy_x[i], enemy_y[i]);
+		enemy_cell[i] = c;
+		cell_start[c + 1] += 1;
+	}
+}
+
+void SwarmSim::rebuild_grid() {
+	uint32_t cells = grid_w * grid_h;
+
+	//enemy_cell and per-cell counts (shifted by one, so the prefix sum yields start indices)
+	// were filled in by move() or count_cells():
+	for (uint32_t c = 0; c < cells; ++c) {
+		cell_start[c + 1] += cell_start[c];
+		cell_cursor[c] = cell_start[c];
+	}
+
+	//scatter into cell order; since enemies were already in (last tick's) cell order,
+	// this reads sequentially and writes nearly sequentially:
+	for (uint32_t i = 0; i < enemy_count; ++i) {
+		uint32_t to = cell_cursor[enemy_cell[i]]++;
+		sort_x[to] = enemy_x[i];
+		sort_y[to] = enemy_y[i];
+		sort_vx[to] = enemy_vx[i];
+		sort_vy[to] = enemy_vy[i];
+	}
+	enemy_x.swap(sort_x);
+	enemy_y.swap(sort_y);
+	enemy_vx.swap(sort_vx);
+	enemy_vy.swap(sort_vy);
+	//(enemy_rx/ry are constant and enemy_dead is all-clear between ticks, so neither needs reordering)
+}
+
+uint32_t SwarmSim::overlapping_enemies(glm::vec2 const &center, glm::vec2 const &radius, uint32_t *first) {
+	//range of cells that can hold the center of an overlapping enemy:
+	glm::vec2 reach = radius + enemy_radius;
+	uint32_t lo = cell_of(center.x - reach.x, center.y - reach.y);
+	uint32_t hi = cell_of(center.x + reach.x, center.y + reach.y);
+	uint32_t x0 = lo % grid_w, y0 = lo / grid_w;
+	uint32_t x1 = hi % grid_w, y1 = hi / grid_w;
+
+	uint32_t found = 0;
+	for (uint32_t y = y0; y <= y1; ++y) {
+		//cells x0..x1 of a grid row hold one contiguous run of enemies:
+		uint32_t begin = cell_start[y * grid_w + x0];
+		uint32_t end = cell_start[y * grid_w + x1 + 1];
+		if (begin == end) continue;
+
+		AABBSoA set;
+		set.x = &enemy_x[begin];
+		set.y = &enemy_y[begin];
+		set.rx = &enemy_rx[begin];
+		set.ry = &enemy_ry[begin];
+		set.count = end - begin;
+		if (aabb_overlap_mask(center, radius, set, hit_words.data()) == 0) continue;
+
+		for (uint32_t w = 0; w < aabb_mask_words(set.count); ++w) {
+			for (uint64_t bits = hit_words[w]; bits; bits &= bits - 1) {
+				uint32_t i = begin + w * 64 + lowest_set_bit(bits);
+				if (enemy_dead[i]) continue;
+				if (found == 0) *first = i;
+				found += 1;
+			}
+		}
+	}
+	return found;
+}
+
+void SwarmSim::collide() {
+	//bullets vs. enemies: each bullet takes out one enemy:
+	for (uint32_t i = 0; i < bullet_count; /* later */) {
+		uint32_t hit;
+		if (overlapping_enemies(glm::vec2(bullet_x[i], bullet_y[i]), bullet_radius, &hit)) {
+			enemy_dead[hit] = 1;
+			shot.emplace_back(hit);
+			enemies_shot += 1;
+			bullet_count -= 1;
+			bullet_x[i] = bullet_x[bullet_count]; bullet_y[i] = bullet_y[bullet_count];
+			bullet_vx[i] = bullet_vx[bullet_count]; bullet_vy[i] = bullet_vy[bullet_count];
+		} else {
+			++i;
+		}
+	}
+
+	//enemies vs. player:
+	uint32_t first;
+	player_hits += overlapping_enemies(player, player_radius, &first);
+}
+
+void SwarmSim::cleanup() {
+	//shot enemies come back at the top, so the swarm stays the same size:
+	// (they get sorted into their new cell by the next tick's rebuild)
+	for (uint32_t i : shot) {
+		respawn_enemy(i);
+		enemy_dead[i] = 0;
+	}
+	shot.clear();
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "Pcg32.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <random>
+#include <cstdint>
+
+/*
+ * SwarmSim is a large-entity variant of the tank game: enemies and bullets
+ *  move freely in 2D instead of in lanes and rows.
+ *
+ * Collisions go through a uniform grid that is rebuilt every tick with a
+ *  counting sort (cells are counted as enemies move). The enemy arrays
+ *  themselves are kept in grid-cell order, so each tick's sort starts from
+ *  nearly-sorted data and scatters almost sequentially, and a run of
+ *  neighbouring cells is one contiguous range that can be handed straight
+ *  to aabb_overlap_mask.
+ *
+ * Like TankSim, it has no SDL or OpenGL dependencies.
+ */
+
+struct SwarmSim {
+	SwarmSim(uint32_t enemy_count, uint32_t max_bullets, glm::vec2 const &court_radius, uint32_t seed = 0);
+
+	//advance the simulation by 'elapsed' seconds:
+	void update(float elapsed);
+
+	//----- settings -----
+	glm::vec2 court_radius;
+	glm::vec2 enemy_radius = glm::vec2(0.15f, 0.15f);
+	glm::vec2 bullet_radius = glm::vec2(0.05f, 0.1f);
+	glm::vec2 player_radius = glm::vec2(1.0f, 1.0f);
+	float bullet_speed = 20.0f;
+	float bullet_spread = 0.5f; //max sideways fraction of bullet_speed
+	float player_speed = 10.0f;
+	float fire_rate = 200.0f; //bullets per second while firing
+
+	//----- input -----
+	float player_move = 0.0f; //-1 (left) to 1 (right)
+	bool firing = false;
+
+	//----- state -----
+	glm::vec2 player;
+
+	//enemies, stored as parallel arrays in grid-cell order:
+	uint32_t enemy_count;
+	std::vector< float > enemy_x, enemy_y, enemy_vx, enemy_vy;
+	std::vector< float > enemy_rx, enemy_ry; //(constant; kept as arrays for aabb_overlap_mask)
+	std::vector< uint8_t > enemy_dead; //shot this tick; respawned at the top of the court in cleanup()
+	std::vector< uint32_t > shot; //indices of enemies shot this tick
+
+	//bullets, in a fixed-capacity pool (removal swaps the last bullet in):
+	uint32_t max_bullets;
+	uint32_t bullet_count = 0;
+	std::vector< float > bullet_x, bullet_y, bullet_vx, bullet_vy;
+	float fire_accumulator = 0.0f;
+
+	//----- broadphase grid -----
+	float cell_size;
+	uint32_t grid_w, grid_h;
+	float inv_cell_size; //1 / cell_size
+	glm::vec2 grid_max; //(grid_w - 1, grid_h - 1)
+	std::vector< uint32_t > cell_start; //enemies in cell c are [cell_start[c], cell_start[c+1])
+	std::vector< uint32_t > enemy_cell; //scratch: cell of each enemy before sorting
+	std::vector< uint32_t > cell_cursor; //scratch: next free slot in each cell while sorting
+	std::vector< float > sort_x, sort_y, sort_vx, sort_vy; //scratch: destination of the counting sort
+	std::vector< uint64_t > hit_words; //scratch: aabb_overlap_mask output
+
+	uint32_t cell_of(float x, float y) const;
+
+	//----- statistics -----
+	uint64_t enemies_shot = 0;
+	uint64_t player_hits = 0; //enemy-ticks spent overlapping the player
+
+	//seconds spent in each phase of the most recent update():
+	struct Timings {
+		double move = 0.0; //integrate enemies, bullets, player; free bullets that left the court; fire new bullets; count enemies per cell
+		double grid = 0.0; //counting-sort enemies into grid-cell order
+		double collide = 0.0; //bullets and player vs. enemies; free bullets that hit
+		double cleanup = 0.0; //respawn shot enemies
+		double total() const { return move + grid + collide + cleanup; }
+	} timings;
+
+	GameRng rng; //(seeded by the constructor)
+
+	//----- update phases -----
+	void move(float elapsed);
+	void rebuild_grid();
+	void count_cells(); //fill enemy_cell and cell counts without moving (move() does this otherwise)
+	void collide();
+	void cleanup();
+
+	void respawn_enemy(uint32_t i);
+	//count living enemies overlapping a box; sets *first to the lowest-indexed one (if any):
+	uint32_t overlapping_enemies(glm::vec2 const &center, glm::vec2 const &radius, uint32_t *first);
+};
@@ -0,0 +1,284 @@
+#include "TankBot.hpp"
+#include "bits.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+void TankBot::lowest_threats(TankSim const &sim, float *lowest) {
+	uint32_t in_flight[64];
+	for (uint32_t lane = 0; lane < sim.lane_count; ++lane) {
+		lowest[lane] = std::numeric_limits< float >::infinity();
+		in_flight[lane] = 0;
+	}
+
+	//each bullet will take out the lowest enemy in its lane:
+	for (uint32_t b = 0; b < sim.bullets.size(); ++b) {
+		uint32_t lane = sim.lane_of(sim.bullets.position[b].x);
+		if (lane < sim.lane_count) in_flight[lane] += 1;
+	}
+
+	//rows are stored lowest first:
+	float passed_y = sim.player.y - sim.player_radius.y - sim.enemy_radius.y;
+	uint64_t found = 0;
+	uint64_t all = (sim.lane_count == 64 ? ~uint64_t(0) : (uint64_t(1) << sim.lane_count) - 1);
+	for (uint32_t r = sim.rows.head; r != sim.rows.tail && found != all; ++r) {
+		TankSim::EnemyRow const &row = sim.rows[r];
+		float y = sim.row_y(row);
+		if (y < passed_y) continue;
+		for (uint64_t lanes = row.lanes & ~found; lanes; lanes &= lanes - 1) {
+			uint32_t lane = lowest_set_bit(lanes);
+			if (in_flight[lane]) {
+				in_flight[lane] -= 1;
+			} else {
+				lowest[lane] = y;
+				found |= uint64_t(1) << lane;
+			}
+		}
+	}
+}
+
+//Depth-first search over (lane, shoot) choices, one choice per enemy movement.
+//Only the rows already on screen are known, so the search can't see new spawns coming;
+// bullets are treated as hitting the lowest enemy in their lane right away.
+struct Lookahead {
+	static constexpr uint32_t MaxRows = 32; //(higher rows are too far away to matter)
+
+	float const *row_y = nullptr; //height of each row now
+	uint64_t lanes[MaxRows]; //living enemies in each row (changed in place by shots, and changed back)
+	uint32_t rows = 0;
+
+	uint32_t lane_count = 0;
+	uint32_t max_reach = 0;
+	float step = 0.0f; //distance rows fall each movement
+	float hit_min = 0.0f, hit_max = 0.0f; //an enemy with y in [hit_min, hit_max] is touching the player
+	float shot_min = 0.0f; //a new bullet hits the lowest enemy with y >= shot_min
+
+	//budget:
+	uint64_t nodes = 0;
+	uint64_t max_nodes = 0;
+	std::chrono::steady_clock::time_point deadline;
+	bool use_deadline = false;
+	bool out_of_budget = false;
+
+	static constexpr float Death = -1000.0f;
+
+	bool hits(uint32_t lane, uint32_t moved) const {
+		uint64_t bit = uint64_t(1) << lane;
+		float drop = step * moved;
+		for (uint32_t r = 0; r < rows; ++r) {
+			float y = row_y[r] - drop;
+			if (y > hit_max) break; //(rows are lowest first)
+			if ((lanes[r] & bit) && y >= hit_min) return true;
+		}
+		return false;
+	}
+
+	//row of the enemy a bullet fired now from 'lane' would hit, or rows if none:
+	uint32_t shot_row(uint32_t lane, uint32_t moved) const {
+		uint64_t bit = uint64_t(1) << lane;
+		float drop = step * moved;
+		for (uint32_t r = 0; r < rows; ++r) {
+			if ((lanes[r] & bit) && row_y[r] - drop >= shot_min) return r;
+		}
+		return rows;
+	}
+
+	float leaf(uint32_t lane, int32_t bullets, uint32_t moved, uint32_t kills) const {
+		//room above the player in its lane, so lines that end in a tight spot look worse:
+		uint32_t r = shot_row(lane, moved);
+		float room = (r < rows ? row_y[r] - step * moved - hit_max : 10.0f);
+		return 2.0f * kills + 3.0f * bullets + 0.1f * std::min(room, 10.0f);
+	}
+
+	bool budget_left() {
+		nodes += 1;
+		if (max_nodes && nodes >= max_nodes) out_of_budget = true;
+		if (use_deadline && (nodes & 63) == 0 && std::chrono::steady_clock::now() >= deadline) out_of_budget = true;
+		return !out_of_budget;
+	}
+
+	//best value reachable from here within 'depth' more movements; at the root, also reports the first choice:
+	float search(uint32_t depth, uint32_t moved, uint32_t lane, int32_t bullets, uint32_t kills, uint32_t *best_lane = nullptr, bool *best_shoot = nullptr) {
+		if (depth == 0 || !budget_left()) return leaf(lane, bullets, moved, kills);
+
+		float best = -std::numeric_limits< float >::infinity();
+		//staying put is tried first, and ties keep the earlier choice, so the bot doesn't fidget:
+		for (uint32_t d = 0; d <= 2 * max_reach; ++d) {
+			int32_t offset = (d == 0 ? 0 : (d % 2 ? 1 : -1) * int32_t((d + 1) / 2));
+			int32_t target_signed = int32_t(lane) + offset;
+			if (target_signed < 0 || target_signed >= int32_t(lane_count)) continue;
+			uint32_t target = uint32_t(target_signed);
+
+			//lanes crossed on the way must be clear right now:
+			bool blocked = false;
+			for (uint32_t l = std::min(lane, target); l <= std::max(lane, target); ++l) {
+				if (l != lane && hits(l, moved)) blocked = true;
+			}
+			if (blocked) continue;
+
+			for (uint32_t shoot = 0; shoot < 2; ++shoot) {
+				uint32_t r = rows;
+				if (shoot) {
+					if (bullets <= 0) break;
+					r = shot_row(target, moved);
+					if (r == rows) break;
+					lanes[r] &= ~(uint64_t(1) << target);
+				}
+
+				float value;
+				if (hits(target, moved + 1)) {
+					value = Death + 10.0f * moved; //(dying later is less bad)
+				} else {
+					value = search(depth - 1, moved + 1, target, bullets - int32_t(shoot), kills + shoot);
+				}
+
+				if (shoot) lanes[r] |= uint64_t(1) << target;
+
+				if (value > best) {
+					best = value;
+					if (best_lane) *best_lane = target;
+					if (best_shoot) *best_shoot = (shoot != 0);
+				}
+			}
+		}
+		//(no safe choice at all: every path crosses an enemy)
+		if (best == -std::numeric_limits< float >::infinity()) best = Death + 10.0f * moved;
+		return best;
+	}
+};
+
+constexpr uint32_t Lookahead::MaxRows; //(std::min takes it by reference, so it needs a definition)
+
+void TankBot::begin_frame() {
+	worst_frame_seconds = std::max(worst_frame_seconds, frame_seconds);
+	frame_seconds = 0.0;
+	frame_seconds_left = budget_seconds;
+	frame_started = true;
+}
+
+void TankBot::plan(TankSim const &sim) {
+	auto before = std::chrono::steady_clock::now();
+
+	uint32_t lane = sim.lane_of(sim.player.x);
+	plan_lane = lane;
+	plan_shoot = false;
+
+	Lookahead look;
+	look.lane_count = sim.lane_count;
+	look.max_reach = max_reach;
+	look.step = sim.enemy_step;
+	float reach_y = sim.player_radius.y + 0.8f * sim.enemy_radius.y;
+	look.hit_min = sim.player.y - reach_y;
+	look.hit_max = sim.player.y + reach_y;
+	look.shot_min = sim.player.y + 0.7f * sim.player_radius.y + sim.bullet_radius.y - sim.enemy_radius.y;
+
+	//copy the rows that haven't passed the player:
+	search_row_y.clear();
+	search_row_lanes.clear();
+	for (uint32_t r = sim.rows.head; r != sim.rows.tail; ++r) {
+		float y = sim.row_y(sim.rows[r]);
+		if (y < look.hit_min || !sim.rows[r].lanes) continue;
+		search_row_y.emplace_back(y);
+		search_row_lanes.emplace_back(sim.rows[r].lanes);
+	}
+	//bullets already in flight take out the lowest enemy above them in their lane:
+	for (uint32_t b = 0; b < sim.bullets.size(); ++b) {
+		uint32_t bullet_lane = sim.lane_of(sim.bullets.position[b].x);
+		if (bullet_lane >= sim.lane_count) continue;
+		float bottom = sim.bullets.position[b].y - sim.bullet_radius.y - sim.enemy_radius.y;
+		for (uint32_t r = 0; r < search_row_y.size(); ++r) {
+			if ((search_row_lanes[r] & (uint64_t(1) << bullet_lane)) && search_row_y[r] >= bottom) {
+				search_row_lanes[r] &= ~(uint64_t(1) << bullet_lane);
+				break;
+			}
+		}
+	}
+	look.rows = std::min< uint32_t >(Lookahead::MaxRows, uint32_t(search_row_y.size()));
+	look.row_y = search_row_y.data();
+	std::copy(search_row_lanes.begin(), search_row_lanes.begin() + look.rows, look.lanes);
+
+	look.max_nodes = budget_nodes;
+	look.use_deadline = (budget_seconds > 0.0f);
+	look.deadline = before + std::chrono::duration_cast< std::chrono::steady_clock::duration >(std::chrono::duration< double >(frame_seconds_left));
+
+	//iterative deepening; a search cut short by the budget is only used if nothing deeper finished:
+	uint32_t depth_done = 0;
+	for (uint32_t depth = 1; depth <= max_depth; ++depth) {
+		uint32_t best_lane = lane;
+		bool best_shoot = false;
+		look.search(depth, 0, lane, sim.bullet_available, 0, &best_lane, &best_shoot);
+		if (look.out_of_budget && depth_done > 0) break;
+		plan_lane = best_lane;
+		plan_shoot = best_shoot;
+		if (look.out_of_budget) break;
+		depth_done = depth;
+	}
+
+	double seconds = std::chrono::duration< double >(std::chrono::steady_clock::now() - before).count();
+	decisions += 1;
+	nodes += look.nodes;
+	depth_total += depth_done;
+	search_seconds += seconds;
+	worst_decision_seconds = std::max(worst_decision_seconds, seconds);
+	frame_seconds += seconds;
+	frame_seconds_left -= seconds;
+}
+
+void TankBot::act(TankSim &sim) {
+	sim.left_up();
+	sim.right_up();
+	sim.shoot_up();
+	if (sim.game_freeze) return;
+
+	if (max_depth > 0) {
+		if (budget_seconds > 0.0f && !frame_started) begin_frame();
+		if (budget_seconds > 0.0f && frame_seconds_left <= 0.0 && decisions > 0) {
+			//this frame's time is spent; keep heading for the last plan's lane:
+			reused_plans += 1;
+		} else {
+			plan(sim);
+		}
+		uint32_t lane = sim.lane_of(sim.player.x);
+		if (plan_lane < lane) sim.left_down();
+		else if (plan_lane > lane) sim.right_down();
+		else if (plan_shoot) {
+			sim.shoot_down();
+			plan_shoot = false; //(each plan shoots at most once, even if it is followed for several ticks)
+		}
+		return;
+	}
+
+	float lowest[64];
+	lowest_threats(sim, lowest);
+
+	uint32_t lane = sim.lane_of(sim.player.x);
+	float threat = lowest[lane] - sim.player.y;
+
+	if (threat > danger_distance) {
+		//safe for now; spend bullets that would otherwise be wasted:
+		if (sim.bullet_available >= sim.tuning.max_bullets && lowest[lane] < sim.court_radius.y) {
+			sim.shoot_down();
+		}
+		return;
+	}
+
+	//in danger: dodge toward the safest lane in reach, if it is clearly safer...
+	uint32_t best = lane;
+	if (lane > 0 && lowest[lane - 1] > lowest[best]) best = lane - 1;
+	if (lane + 1 < sim.lane_count && lowest[lane + 1] > lowest[best]) best = lane + 1;
+	if (best != lane && lowest[best] - sim.player.y > danger_distance) {
+		if (best < lane) sim.left_down();
+		else sim.right_down();
+		return;
+	}
+
+	//...otherwise shoot our way out (or, with no bullets, take the best dodge there is):
+	if (sim.bullet_available > 0) {
+		sim.shoot_down();
+	} else if (best < lane) {
+		sim.left_down();
+	} else if (best > lane) {
+		sim.right_down();
+	}
+}
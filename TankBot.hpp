@@ -0,0 +1,73 @@
+#pragma once
+
+#include "TankSim.hpp"
+
+#include <vector>
+
+/*
+ * TankBot plays TankSim through the same inputs a player has
+ *  (left, right, shoot), so it can drive games unattended: headless
+ *  games for tuning, and NewMode itself for soak testing.
+ *
+ * By default it is a simple scripted player: it looks at the lowest enemy
+ *  in each lane, and when the one in its own lane gets close it dodges to
+ *  a safer lane or shoots it. Spare bullets (ones that would be wasted
+ *  because the player can't hold more) are spent on points.
+ *
+ * With max_depth > 0 it instead plans ahead: every decision searches
+ *  (depth-first, iteratively deepened) over lane moves and shots for up to
+ *  max_depth enemy movements against the rows already on screen, and stops
+ *  deepening when the budget runs out. The time budget is per frame and
+ *  shared by all of the frame's decisions (a frame can run many update
+ *  ticks); once it is spent, the rest of the frame's ticks follow the last
+ *  plan without searching.
+ */
+
+struct TankBot {
+	//react once the lowest enemy in the player's lane is this far (court units) above the player:
+	float danger_distance = 2.5f;
+
+	//release last tick's keys and press this tick's (call before each sim.update()):
+	void act(TankSim &sim);
+
+	//height of the lowest living enemy in each lane that hasn't yet passed the player,
+	// not counting enemies that bullets already in flight will hit (+infinity if none):
+	static void lowest_threats(TankSim const &sim, float *lowest);
+
+	//----- look-ahead -----
+
+	uint32_t max_depth = 0; //enemy movements to plan ahead (0 = scripted play, no search)
+	uint32_t max_reach = 2; //farthest lane change considered between two enemy movements
+	float budget_seconds = 0.0005f; //CPU time per frame, for all of its decisions together (0 = no limit)
+	uint64_t budget_nodes = 0; //search nodes per decision (0 = no limit; unlike time, repeatable across machines)
+
+	//with a time budget, call once per frame to refill it (the first decision starts a frame if this hasn't been called):
+	void begin_frame();
+	bool frame_started = false;
+	double frame_seconds_left = 0.0; //(budget left this frame)
+	double frame_seconds = 0.0; //(search time so far this frame)
+
+	//the current plan (the first step of the best line found):
+	uint32_t plan_lane = 0;
+	bool plan_shoot = false;
+
+	//metrics, summed over every decision that searched:
+	uint64_t decisions = 0;
+	uint64_t nodes = 0;
+	uint64_t depth_total = 0; //deepest complete search depth, summed
+	double search_seconds = 0.0;
+	double worst_decision_seconds = 0.0;
+	double worst_frame_seconds = 0.0; //(most search time in one frame)
+	uint64_t reused_plans = 0; //decisions that followed the last plan because the frame's budget was spent
+
+	double nodes_per_second() const { return search_seconds > 0.0 ? nodes / search_seconds : 0.0; }
+	double seconds_per_decision() const { return decisions ? search_seconds / decisions : 0.0; }
+	double mean_depth() const { return decisions ? double(depth_total) / decisions : 0.0; }
+
+	//run the search and set plan_lane and plan_shoot:
+	void plan(TankSim const &sim);
+
+	//rows the search knows about (copied from the sim each decision, lowest first):
+	std::vector< float > search_row_y;
+	std::vector< uint64_t > search_row_lanes;
+};
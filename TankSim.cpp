@@ -0,0 +1,391 @@
+#include "TankSim.hpp"
+#include "RowGenerator.hpp"
+#include "bits.hpp"
+
+#include <random>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+//number of set bits (i.e., enemies in a row):
+static uint32_t count_lanes(uint64_t lanes) {
+	uint32_t count = 0;
+	while (lanes) {
+		lanes &= lanes - 1;
+		count += 1;
+	}
+	return count;
+}
+
+void TankSim::EnemyRows::reset(uint32_t min_capacity) {
+	uint32_t capacity = 1;
+	while (capacity < min_capacity) capacity *= 2;
+	ring.assign(capacity, EnemyRow{0.0f, 0, 0});
+	mask = capacity - 1;
+	head = tail = 0;
+}
+
+TankSim::TankSim(glm::vec2 const &court_radius_, uint32_t seed, TankTuning const &tuning_, RowGenerator *row_source_) : court_radius(court_radius_), tuning(tuning_), rng(seed), row_source(row_source_) {
+	lane_width = 2.0f * player_radius.x;
+	lane_count = uint32_t(2.0f * court_radius.x / lane_width + 0.5f);
+	assert(lane_count >= 1 && lane_count <= 64 && "lanes are stored as bits of a uint64_t");
+
+	bullets.reset(BulletCapacity);
+
+	{ //initialize enemies
+		float starting_y = player.y + enemy_interval;
+		while (starting_y < court_radius.y) {
+			starting_y += enemy_interval;
+		}
+		spawn_y = starting_y;
+
+		//rows are at least enemy_interval apart between spawn_y and where they retire (below the player):
+		float retire_y = player.y - player_radius.y * 2.0f;
+		rows.reset(uint32_t(std::ceil((spawn_y - retire_y) / enemy_interval)) + 2);
+		lane_buckets.assign(lane_count, LaneBucket());
+		lane_bucket_ids.assign(lane_count * rows.ring.size(), 0);
+
+		starting_y = player.y + enemy_interval;
+		while (starting_y < court_radius.y) {
+			add_enemies(starting_y, 2);
+			starting_y += enemy_interval;
+		}
+	}
+}
+
+void TankSim::left_down() {
+	if (left_locked) return;
+	go_left = true;
+	go_right = false;
+	left_locked = true;
+}
+
+void TankSim::left_up() {
+	left_locked = false;
+}
+
+void TankSim::right_down() {
+	if (right_locked) return;
+	go_right = true;
+	go_left = false;
+	right_locked = true;
+}
+
+void TankSim::right_up() {
+	right_locked = false;
+}
+
+void TankSim::shoot_down() {
+	if (shoot_locked || bullet_available <= 0) return;
+	player_shoot = true;
+	shoot_locked = true;
+}
+
+void TankSim::shoot_up() {
+	shoot_locked = false;
+}
+
+void TankSim::update(float elapsed) {
+	if (game_freeze) return;
+
+	ticks += 1;
+
+	//---- player update ----
+	if (go_right) {
+		player.x += 2.0f;
+		go_right = false;
+	}
+	else if (go_left) {
+		player.x -= 2.0f;
+		go_left = false;
+	}
+
+	player.x = std::max(player.x, -court_radius.x + player_radius.x);
+	player.x = std::min(player.x, court_radius.x - player_radius.x);
+
+	if (player_shoot ) {
+		player_shoot = false;
+		//(a full pool holds the shot rather than spending a bullet)
+		if (bullet_available > 0 && !bullets.full()) {
+			bullet_available--;
+			bullet_used++;
+			bullets.create(BulletKind, player + glm::vec2(0.0f, 0.7f * player_radius.y + 2.0f * bullet_radius.y), bullet_radius, bullet_speed);
+			//std::cout << "Bullets available is" << bullet_available << "\n";
+		}
+	}
+		
+	//---- enemy update ----
+	assert(time_since_last_movement >= 0.0f);
+	time_since_last_movement += elapsed;
+	if (time_since_last_movement > movement_interval) {
+		time_since_last_movement -= movement_interval;
+
+		//move every row down:
+		movement_steps += 1;
+
+		//retire rows that are now below the player (oldest rows are lowest):
+		uint32_t removed = 0;
+		while (!rows.empty() && row_y(rows.front()) < (player.y - player_radius.y * 2.0f)) {
+			removed += count_lanes(rows.front().lanes);
+			rows.pop_front();
+		}
+		enemy_count -= removed;
+
+		if (removed) {
+			score += removed;
+			if (bullet_available < tuning.max_bullets) {
+				enemy_survived += removed;
+			}
+			row_survived++;
+			bullet_available = (int)enemy_survived / tuning.enemies_per_bullet - bullet_used + 1;
+			bullet_available = std::min(tuning.max_bullets, bullet_available);
+			//std::cout << "bullet_available: " << bullet_available << "\n";				
+			movement_interval = std::max(tuning.start_interval / (row_survived / tuning.rows_per_speedup + 1.0f), tuning.min_interval);
+		}
+
+		//(rows whose enemies were all shot stay in the ring, so spacing stays even)
+		if (rows.empty() || row_y(rows.back()) < spawn_y - enemy_interval) {
+
+			int expected_bullet_num = bullet_available + (int) enemy_count / tuning.enemies_per_bullet - std::max((uint32_t)0, three_row_num) - 1;
+			//std::cout << "Expected number of bullet is: " << expected_bullet_num << "\n";
+
+			int max_enemy = 2;
+			if (expected_bullet_num > 0) {
+				if (three_in_a_row < bullet_available) {
+					max_enemy = 3;
+					three_in_a_row++;
+				}
+				else {
+					max_enemy = 2;
+					three_in_a_row = 0;
+				}
+			}
+			//std::cout << "max_enemy is: " << max_enemy << "\n";
+			add_enemies(spawn_y, max_enemy);
+		}
+	}	
+
+	//---- bullet update ----
+	bullets.integrate(elapsed);
+	for (uint32_t i = 0; i < bullets.size(); /* later */) {
+		if (bullets.position[i].y > court_radius.y) {
+			bullets.destroy_at(i); //(index i now holds a different bullet, so check it next)
+		} else {
+			i++;
+		}
+	}
+
+	//---- collision handling ----
+	auto rect_a_vs_b = [](glm::vec2 const& a_pos, glm::vec2 const& a_rad, glm::vec2 const& b_pos, glm::vec2 const& b_rad) {
+		//compute area of overlap:
+		glm::vec2 min = glm::max(a_pos - a_rad, b_pos - b_rad);
+		glm::vec2 max = glm::min(a_pos + a_rad, b_pos + b_rad);
+
+		//if no overlap, no collision:
+		if (min.x > max.x || min.y > max.y) return false;
+		return true;
+	};
+
+	//bullet vs enemy
+	for (uint32_t i = 0; i < bullets.size(); /* later */) {
+		//only the lowest enemy in the bullet's lane that isn't entirely below it can be hit:
+		glm::vec2 const &at = bullets.position[i];
+		glm::vec2 const &radius = bullets.radius[i];
+		uint32_t lane = lane_of(at.x);
+		uint32_t id;
+		if (lane < lane_count
+			&& lowest_enemy_above(lane, at.y - radius.y, enemy_radius.y, &id)
+			&& rect_a_vs_b(at, radius, glm::vec2(lane_x(lane), row_y(rows[id])), enemy_radius)) {
+			rows[id].lanes &= ~(uint64_t(1) << lane);
+			enemy_count--;
+			three_row_num--;
+			score += 2;
+			bullets.destroy_at(i);
+		} else {
+			i++;
+		}
+	}
+
+	//enemy vs player
+	{
+		//likewise, only the lowest enemy in the player's lane can reach the player:
+		uint32_t lane = lane_of(player.x);
+		uint32_t id;
+		if (lane < lane_count
+			&& lowest_enemy_above(lane, player.y - player_radius.y, enemy_radius.y * 0.8f, &id)
+			&& rect_a_vs_b(player, player_radius, glm::vec2(lane_x(lane), row_y(rows[id])), enemy_radius * 0.8f)) {
+			game_freeze = true;
+			return;
+		}
+	}
+}
+
+bool TankSim::lowest_enemy_above(uint32_t lane, float min_y, float radius_y, uint32_t *id_) {
+	assert(lane < lane_count);
+	LaneBucket &bucket = lane_buckets[lane];
+	uint32_t const *ids = &lane_bucket_ids[lane * rows.ring.size()];
+
+	//drop entries for dead enemies from the front:
+	while (bucket.head != bucket.tail && !enemy_alive(ids[bucket.head & rows.mask], lane)) {
+		bucket.head += 1;
+	}
+
+	//entries are lowest-first, so the first living enemy that reaches min_y is the one:
+	// (living enemies below min_y are rare -- they have already slipped past the player)
+	for (uint32_t n = bucket.head; n != bucket.tail; ++n) {
+		uint32_t id = ids[n & rows.mask];
+		if (!enemy_alive(id, lane)) continue;
+		if (row_y(rows[id]) + radius_y >= min_y) {
+			*id_ = id;
+			return true;
+		}
+	}
+	return false;
+}
+
+void TankSim::add_enemies(float pos_y, int max_num)
+{
+	int num, pos;
+	if (row_source) {
+		//scale the precomputed draws into [1, max_num] and [0, lane_count):
+		RowGenerator::Row row = row_source->pop();
+		num = int((uint64_t(row.count_draw) * uint32_t(max_num)) >> 32) + 1;
+		pos = int((uint64_t(row.lane_draw) * lane_count) >> 32);
+	} else {
+		std::uniform_int_distribution<> num_dist(1, max_num);
+		num = num_dist(rng);
+		std::uniform_int_distribution<> pos_dist(0, lane_count - 1);
+		pos = pos_dist(rng);
+	}
+	//std::cout << "Number of enemy this row is: " << num << "\n";
+	//std::cout << "Randomed position is " << pos << "\n";
+
+	//all lanes, all lanes but 'pos', or just 'pos':
+	uint64_t all = (lane_count == 64 ? ~uint64_t(0) : (uint64_t(1) << lane_count) - 1);
+	uint64_t lanes;
+	if (num == 3) {
+		lanes = all;
+		three_row_num++;
+	}
+	else if (num == 2) {
+		lanes = all & ~(uint64_t(1) << pos);
+	}
+	else {
+		lanes = uint64_t(1) << pos;
+	}
+
+	uint32_t id = rows.tail;
+	rows.push_back(EnemyRow{pos_y, movement_steps, lanes});
+	enemy_count += count_lanes(lanes);
+	add_to_buckets(id);
+}
+
+void TankSim::add_to_buckets(uint32_t id) {
+	for (uint64_t lanes = rows[id].lanes; lanes; lanes &= lanes - 1) {
+		uint32_t lane = lowest_set_bit(lanes);
+		LaneBucket &bucket = lane_buckets[lane];
+		uint32_t *ids = &lane_bucket_ids[lane * rows.ring.size()];
+		while (bucket.head != bucket.tail && !enemy_alive(ids[bucket.head & rows.mask], lane)) {
+			bucket.head += 1;
+		}
+		assert(bucket.tail - bucket.head <= rows.mask && "lane bucket is full");
+		ids[bucket.tail & rows.mask] = id;
+		bucket.tail += 1;
+	}
+}
+
+void TankSim::save(TankSnapshot *snapshot_) const {
+	assert(snapshot_);
+	TankSnapshot &snapshot = *snapshot_;
+	assert(rows.size() <= TankSnapshot::MaxRows && "court too tall to snapshot");
+
+	snapshot.tuning = tuning;
+	snapshot.court_radius = court_radius;
+
+	snapshot.time_since_last_movement = time_since_last_movement;
+	snapshot.movement_interval = movement_interval;
+	snapshot.movement_steps = movement_steps;
+	snapshot.enemy_count = enemy_count;
+	snapshot.row_head = rows.head;
+	snapshot.row_count = rows.size();
+	for (uint32_t i = 0; i < snapshot.row_count; ++i) {
+		snapshot.rows[i] = rows[rows.head + i];
+	}
+
+	snapshot.three_row_num = three_row_num;
+	snapshot.three_in_a_row = three_in_a_row;
+	snapshot.bullet_available = bullet_available;
+	snapshot.bullet_used = bullet_used;
+	snapshot.bullet_count = bullets.size();
+	std::memcpy(snapshot.bullets, bullets.position.data(), sizeof(glm::vec2) * bullets.size());
+
+	snapshot.player = player;
+	snapshot.score = score;
+	snapshot.enemy_survived = enemy_survived;
+	snapshot.row_survived = row_survived;
+
+	snapshot.go_right = go_right;
+	snapshot.right_locked = right_locked;
+	snapshot.go_left = go_left;
+	snapshot.left_locked = left_locked;
+	snapshot.player_shoot = player_shoot;
+	snapshot.shoot_locked = shoot_locked;
+	snapshot.game_freeze = game_freeze;
+
+	snapshot.ticks = ticks;
+	snapshot.rng = rng;
+}
+
+void TankSim::restore(TankSnapshot const &snapshot) {
+	assert(snapshot.court_radius == court_radius && "snapshot is from a different court");
+	assert(snapshot.row_count <= rows.ring.size());
+	assert(snapshot.bullet_count <= bullets.capacity());
+
+	tuning = snapshot.tuning;
+	enemy_interval = tuning.row_spacing;
+
+	time_since_last_movement = snapshot.time_since_last_movement;
+	movement_interval = snapshot.movement_interval;
+	movement_steps = snapshot.movement_steps;
+	enemy_count = snapshot.enemy_count;
+	rows.head = snapshot.row_head;
+	rows.tail = snapshot.row_head;
+	for (uint32_t i = 0; i < snapshot.row_count; ++i) {
+		rows.push_back(snapshot.rows[i]);
+	}
+
+	//rebuild the broadphase from the rows (it only ever holds ids of rows, lowest first):
+	for (LaneBucket &bucket : lane_buckets) {
+		bucket.head = bucket.tail = 0;
+	}
+	for (uint32_t id = rows.head; id != rows.tail; ++id) {
+		add_to_buckets(id);
+	}
+
+	three_row_num = snapshot.three_row_num;
+	three_in_a_row = snapshot.three_in_a_row;
+	bullet_available = snapshot.bullet_available;
+	bullet_used = snapshot.bullet_used;
+	while (!bullets.empty()) {
+		bullets.destroy_at(bullets.size() - 1);
+	}
+	for (uint32_t i = 0; i < snapshot.bullet_count; ++i) {
+		bullets.create(BulletKind, snapshot.bullets[i], bullet_radius, bullet_speed);
+	}
+
+	player = snapshot.player;
+	score = snapshot.score;
+	enemy_survived = snapshot.enemy_survived;
+	row_survived = snapshot.row_survived;
+
+	go_right = snapshot.go_right;
+	right_locked = snapshot.right_locked;
+	go_left = snapshot.go_left;
+	left_locked = snapshot.left_locked;
+	player_shoot = snapshot.player_shoot;
+	shoot_locked = snapshot.shoot_locked;
+	game_freeze = snapshot.game_freeze;
+
+	ticks = snapshot.ticks;
+	rng = snapshot.rng;
+}
@@ -0,0 +1,223 @@
+#pragma once
+
+#include "Pcg32.hpp"
+#include "EntityStore.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstdint>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+
+/*
+ * TankSim holds the game state and rules for NewMode ("Charging Tank").
+ * It does not depend on SDL or OpenGL, so it can be stepped headless
+ *  (see sim_main.cpp) as well as from NewMode.
+ */
+
+//constants that shape the difficulty curve (the defaults are the shipped game; see tune_main.cpp):
+struct TankTuning {
+	float start_interval = 1.0f; //seconds between enemy movements at the start
+	float min_interval = 0.12f; //enemies never move more often than this
+	float rows_per_speedup = 2.0f; //movement interval is start_interval / (1 + rows survived / rows_per_speedup)
+	float row_spacing = 3.5f; //distance between rows of enemies
+	int32_t max_bullets = 5; //most bullets the player can hold
+	int32_t enemies_per_bullet = 5; //enemies that must get past the player to earn a bullet
+};
+
+struct TankSnapshot;
+struct RowGenerator;
+
+struct TankSim {
+	//court_radius sets the size of the play area; taller courts hold more rows of enemies.
+	//the same seed (and the same input) always plays out the same game.
+	//if row_source is given, rows are made from its draws instead of rng (it must outlive the sim):
+	explicit TankSim(glm::vec2 const &court_radius = glm::vec2(3.0f, 7.0f), uint32_t seed = 0, TankTuning const &tuning = TankTuning(), RowGenerator *row_source = nullptr);
+
+	//advance the simulation by 'elapsed' seconds:
+	void update(float elapsed);
+
+	//copy the complete game state (including the random number generator) to or from a snapshot.
+	//restore() needs a sim built with the same court_radius, and gives bit-for-bit the state that was saved.
+	//(rows queued in a row_source are not part of the state, so rollback needs a sim without one)
+	void save(TankSnapshot *snapshot) const;
+	void restore(TankSnapshot const &snapshot);
+
+	//----- input -----
+	//These mirror the keys handled by NewMode::handle_event;
+	// a held key only acts once until it is released.
+	void left_down();
+	void left_up();
+	void right_down();
+	void right_up();
+	void shoot_down();
+	void shoot_up();
+
+	//----- game state -----
+	glm::vec2 court_radius;
+	TankTuning tuning;
+
+	// enemy
+	float time_since_last_movement = 0.0f;
+	float movement_interval = tuning.start_interval;
+	float enemy_interval = tuning.row_spacing;
+	float enemy_step = 0.5f; //distance enemies move down each movement
+	float spawn_y;
+
+	//Enemies spawn a whole row at a time (all at spawn_y) and leave in the
+	// same order, so they are stored as a fixed-capacity ring of rows.
+	//Rows don't store their current height; instead, each remembers the
+	// movement step it was spawned on, so moving every row is just
+	// 'movement_steps += 1'.
+	struct EnemyRow {
+		float start_y; //height when spawned
+		uint32_t start_step; //value of movement_steps when spawned
+		uint64_t lanes; //bit i set => enemy in lane i
+	};
+	struct EnemyRows {
+		std::vector< EnemyRow > ring; //size is a power of two, fixed at construction
+		uint32_t mask = 0; //ring.size() - 1
+		//rows are numbered by ever-increasing ids; row 'id' is stored at ring[id & mask]:
+		uint32_t head = 0; //id of oldest row
+		uint32_t tail = 0; //one past id of newest row
+
+		void reset(uint32_t min_capacity);
+		uint32_t size() const { return tail - head; }
+		bool empty() const { return tail == head; }
+		EnemyRow &operator[](uint32_t id) { return ring[id & mask]; }
+		EnemyRow const &operator[](uint32_t id) const { return ring[id & mask]; }
+		EnemyRow &front() { return ring[head & mask]; }
+		EnemyRow &back() { return ring[(tail - 1) & mask]; }
+		void push_back(EnemyRow const &row) {
+			assert(size() <= mask && "EnemyRows ring is full");
+			ring[tail & mask] = row;
+			tail += 1;
+		}
+		void pop_front() {
+			assert(!empty());
+			head += 1;
+		}
+	} rows;
+	uint32_t movement_steps = 0; //number of times enemies have moved down
+	uint32_t enemy_count = 0; //total enemies in all rows
+
+	float row_y(EnemyRow const &row) const {
+		return row.start_y - enemy_step * float(movement_steps - row.start_step);
+	}
+
+	//Collision broadphase: for each lane, the ids of rows that spawned an
+	// enemy in that lane, lowest first. Entries for enemies that have since
+	// been shot or retired are skipped, and dropped once they reach the front.
+	struct LaneBucket {
+		uint32_t head = 0;
+		uint32_t tail = 0;
+	};
+	std::vector< LaneBucket > lane_buckets; //[lane_count]
+	std::vector< uint32_t > lane_bucket_ids; //lane l's n'th entry is at [l * rows.ring.size() + (n & rows.mask)]
+
+	bool enemy_alive(uint32_t id, uint32_t lane) const {
+		//(ids wrap, so compare by difference)
+		return int32_t(id - rows.head) >= 0 && (rows[id].lanes & (uint64_t(1) << lane));
+	}
+	//find the lowest living enemy in 'lane' whose top (row y + radius_y) is at or above min_y:
+	bool lowest_enemy_above(uint32_t lane, float min_y, float radius_y, uint32_t *id);
+	//add row 'id' to the buckets of the lanes it occupies:
+	void add_to_buckets(uint32_t id);
+
+	//enemies (and the player) sit in evenly-spaced vertical lanes:
+	uint32_t lane_count;
+	float lane_width;
+	float lane_x(uint32_t lane) const {
+		return (float(lane) - 0.5f * float(lane_count - 1)) * lane_width;
+	}
+	uint32_t lane_of(float x) const {
+		return uint32_t(std::lround(x / lane_width + 0.5f * float(lane_count - 1)));
+	}
+
+	glm::vec2 bullet_radius = glm::vec2(0.2f, 0.4f);
+	glm::vec2 enemy_radius = glm::vec2(0.6f, 0.6f);
+	glm::vec2 player_radius = glm::vec2(1.0f, 1.0f);
+
+	// bullets
+	uint32_t three_row_num = 0;
+	int32_t three_in_a_row = 0;
+	int32_t bullet_available = 1;
+	uint32_t bullet_used = 0;
+
+	//Bullets are entities (position, radius, velocity) in a fixed-capacity store, so firing never allocates:
+	EntityStore bullets;
+	static constexpr uint8_t BulletKind = 1;
+	static constexpr uint32_t BulletCapacity = 64; //more than can be in flight at the normal fire rate
+	glm::vec2 bullet_speed = glm::vec2(0.0f, 5.0f);
+
+	// player
+	glm::vec2 player = glm::vec2(0.0f, -court_radius.y + 1.0f);
+
+	uint32_t score = 0;
+	uint32_t enemy_survived = 0;
+	uint32_t row_survived = 0;
+
+	bool go_right = false;
+	bool right_locked = false;
+	bool go_left = false;
+	bool left_locked = false;
+	bool player_shoot = false;
+	bool shoot_locked = false;
+
+	bool game_freeze = false;
+
+	//number of updates simulated before the game froze (or so far):
+	uint64_t ticks = 0;
+
+	//each simulation owns its generator, so simulations don't affect each other:
+	GameRng rng;
+	RowGenerator *row_source = nullptr; //(not owned)
+
+	void add_enemies(float pos_y, int max_num);
+};
+
+//TankSnapshot is the whole state of a TankSim as plain data, so it can be
+// copied with memcpy, kept in arrays (e.g. for rollback), or written to disk.
+//Only the state itself is stored; the collision broadphase is rebuilt on restore.
+struct TankSnapshot {
+	static constexpr uint32_t MaxRows = 64; //enough for courts up to ~100 units tall
+	static constexpr uint32_t MaxBullets = TankSim::BulletCapacity;
+
+	//(zeroed up front, padding included, so equal states give equal bytes)
+	TankSnapshot() { std::memset(static_cast< void * >(this), 0, sizeof(*this)); }
+
+	TankTuning tuning;
+	glm::vec2 court_radius;
+
+	float time_since_last_movement;
+	float movement_interval;
+	uint32_t movement_steps;
+	uint32_t enemy_count;
+	uint32_t row_head; //id of rows[0]
+	uint32_t row_count;
+	TankSim::EnemyRow rows[MaxRows];
+
+	uint32_t three_row_num;
+	int32_t three_in_a_row;
+	int32_t bullet_available;
+	uint32_t bullet_used;
+	uint32_t bullet_count;
+	glm::vec2 bullets[MaxBullets];
+
+	glm::vec2 player;
+	uint32_t score;
+	uint32_t enemy_survived;
+	uint32_t row_survived;
+
+	bool go_right, right_locked;
+	bool go_left, left_locked;
+	bool player_shoot, shoot_locked;
+	bool game_freeze;
+
+	uint64_t ticks;
+	GameRng rng;
+};
+static_assert(std::is_trivially_copyable< TankSnapshot >::value, "TankSnapshot should be memcpy-able");
@@ -0,0 +1,112 @@
+#include "aabb_overlap.hpp"
+
+#include <algorithm>
+
+#if defined(__AVX2__)
+	#define AABB_AVX2
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define AABB_SSE2
+	#include <emmintrin.h>
+#endif
+
+//the per-pair test, written the same way as rect_a_vs_b / paddle_vs_ball:
+static inline bool overlaps(float ax, float ay, float arx, float ary, float bx, float by, float brx, float bry) {
+	float min_x = std::max(ax - arx, bx - brx);
+	float max_x = std::min(ax + arx, bx + brx);
+	float min_y = std::max(ay - ary, by - bry);
+	float max_y = std::min(ay + ary, by + bry);
+	return !(min_x > max_x || min_y > max_y);
+}
+
+//test boxes [begin, set.count) one at a time, or'ing into already-cleared hits:
+static uint32_t overlap_tail(glm::vec2 const &center, glm::vec2 const &radius, AABBSoA const &set, uint32_t begin, uint64_t *hits) {
+	uint32_t found = 0;
+	for (uint32_t i = begin; i < set.count; ++i) {
+		if (overlaps(center.x, center.y, radius.x, radius.y, set.x[i], set.y[i], set.rx[i], set.ry[i])) {
+			hits[i / 64] |= uint64_t(1) << (i % 64);
+			found += 1;
+		}
+	}
+	return found;
+}
+
+#if defined(AABB_AVX2) || defined(AABB_SSE2)
+static uint32_t count_bits(uint32_t bits) {
+	uint32_t count = 0;
+	while (bits) {
+		bits &= bits - 1;
+		count += 1;
+	}
+	return count;
+}
+#endif
+
+uint32_t aabb_overlap_mask_scalar(glm::vec2 const &center, glm::vec2 const &radius, AABBSoA const &set, uint64_t *hits) {
+	std::fill(hits, hits + aabb_mask_words(set.count), uint64_t(0));
+	return overlap_tail(center, radius, set, 0, hits);
+}
+
+uint32_t aabb_overlap_mask(glm::vec2 const &center, glm::vec2 const &radius, AABBSoA const &set, uint64_t *hits) {
+	std::fill(hits, hits + aabb_mask_words(set.count), uint64_t(0));
+	uint32_t found = 0;
+	uint32_t i = 0;
+
+#if defined(AABB_AVX2)
+	__m256 const cx = _mm256_set1_ps(center.x), cy = _mm256_set1_ps(center.y);
+	__m256 const crx = _mm256_set1_ps(radius.x), cry = _mm256_set1_ps(radius.y);
+	__m256 const c_min_x = _mm256_sub_ps(cx, crx), c_max_x = _mm256_add_ps(cx, crx);
+	__m256 const c_min_y = _mm256_sub_ps(cy, cry), c_max_y = _mm256_add_ps(cy, cry);
+	for (; i + 8 <= set.count; i += 8) {
+		__m256 x = _mm256_loadu_ps(set.x + i), y = _mm256_loadu_ps(set.y + i);
+		__m256 rx = _mm256_loadu_ps(set.rx + i), ry = _mm256_loadu_ps(set.ry + i);
+		__m256 min_x = _mm256_max_ps(c_min_x, _mm256_sub_ps(x, rx));
+		__m256 max_x = _mm256_min_ps(c_max_x, _mm256_add_ps(x, rx));
+		__m256 min_y = _mm256_max_ps(c_min_y, _mm256_sub_ps(y, ry));
+		__m256 max_y = _mm256_min_ps(c_max_y, _mm256_add_ps(y, ry));
+		__m256 hit = _mm256_and_ps(_mm256_cmp_ps(min_x, max_x, _CMP_LE_OQ), _mm256_cmp_ps(min_y, max_y, _CMP_LE_OQ));
+		uint32_t bits = uint32_t(_mm256_movemask_ps(hit));
+		hits[i / 64] |= uint64_t(bits) << (i % 64);
+		found += count_bits(bits);
+	}
+#elif defined(AABB_SSE2)
+	__m128 const cx = _mm_set1_ps(center.x), cy = _mm_set1_ps(center.y);
+	__m128 const crx = _mm_set1_ps(radius.x), cry = _mm_set1_ps(radius.y);
+	__m128 const c_min_x = _mm_sub_ps(cx, crx), c_max_x = _mm_add_ps(cx, crx);
+	__m128 const c_min_y = _mm_sub_ps(cy, cry), c_max_y = _mm_add_ps(cy, cry);
+	for (; i + 4 <= set.count; i += 4) {
+		__m128 x = _mm_loadu_ps(set.x + i), y = _mm_loadu_ps(set.y + i);
+		__m128 rx = _mm_loadu_ps(set.rx + i), ry = _mm_loadu_ps(set.ry + i);
+		__m128 min_x = _mm_max_ps(c_min_x, _mm_sub_ps(x, rx));
+		__m128 max_x = _mm_min_ps(c_max_x, _mm_add_ps(x, rx));
+		__m128 min_y = _mm_max_ps(c_min_y, _mm_sub_ps(y, ry));
+		__m128 max_y = _mm_min_ps(c_max_y, _mm_add_ps(y, ry));
+		__m128 hit = _mm_and_ps(_mm_cmple_ps(min_x, max_x), _mm_cmple_ps(min_y, max_y));
+		uint32_t bits = uint32_t(_mm_movemask_ps(hit));
+		hits[i / 64] |= uint64_t(bits) << (i % 64);
+		found += count_bits(bits);
+	}
+#endif
+
+	//(i is a multiple of the vector width, and 64 is a multiple of that, so groups never straddle words)
+	return found + overlap_tail(center, radius, set, i, hits);
+}
+
+uint32_t aabb_overlap_masks(uint32_t queries, glm::vec2 const *centers, glm::vec2 const *radii, AABBSoA const &set, uint64_t *hits) {
+	uint32_t words = aabb_mask_words(set.count);
+	uint32_t found = 0;
+	for (uint32_t q = 0; q < queries; ++q) {
+		found += aabb_overlap_mask(centers[q], radii[q], set, hits + size_t(q) * words);
+	}
+	return found;
+}
+
+char const *aabb_overlap_path() {
+#if defined(AABB_AVX2)
+	return "avx2";
+#elif defined(AABB_SSE2)
+	return "sse2";
+#else
+	return "scalar";
+#endif
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+/*
+ * Batch overlap tests of axis-aligned boxes (stored as center +/- radius)
+ *  against a packed structure-of-arrays set of boxes.
+ *
+ * Overlap is decided exactly as in the per-pair tests in TankSim and
+ *  PongMode (boxes that just touch overlap), so results match them bit-for-bit.
+ *
+ * The SoA set is tested with AVX2 (8 boxes at a time) when built with
+ *  -mavx2 or /arch:AVX2, with SSE2 (4 at a time) on other x86 builds,
+ *  and with a scalar loop everywhere else.
+ */
+
+//a set of 'count' boxes; box i has center (x[i],y[i]) and radius (rx[i],ry[i]):
+struct AABBSoA {
+	float const *x = nullptr;
+	float const *y = nullptr;
+	float const *rx = nullptr;
+	float const *ry = nullptr;
+	uint32_t count = 0;
+};
+
+//number of uint64_t words needed to hold one hit bit per box:
+inline uint32_t aabb_mask_words(uint32_t count) { return (count + 63) / 64; }
+
+//test one box against every box in 'set':
+// bit (i % 64) of hits[i / 64] is set if set box i overlaps; hits must hold aabb_mask_words(set.count) words.
+// returns the number of overlapping boxes.
+uint32_t aabb_overlap_mask(glm::vec2 const &center, glm::vec2 const &radius, AABBSoA const &set, uint64_t *hits);
+
+//test 'queries' boxes against every box in 'set':
+// query q's mask starts at hits[q * aabb_mask_words(set.count)].
+// returns the total number of overlapping pairs.
+uint32_t aabb_overlap_masks(uint32_t queries, glm::vec2 const *centers, glm::vec2 const *radii, AABBSoA const &set, uint64_t *hits);
+
+//same as aabb_overlap_mask, but never vectorized (for reference and benchmarking):
+uint32_t aabb_overlap_mask_scalar(glm::vec2 const &center, glm::vec2 const &radius, AABBSoA const &set, uint64_t *hits);
+
+//name of the code path aabb_overlap_mask uses ("avx2", "sse2", or "scalar"):
+char const *aabb_overlap_path();
@@ -0,0 +1,39 @@
+#include "allocation_count.hpp"
+
+#include <cstdlib>
+#include <new>
+
+//(per-thread, so a background thread allocating doesn't show up in another thread's count)
+static thread_local uint64_t count = 0;
+
+uint64_t allocation_count() {
+	return count;
+}
+
+//Only debug builds (the ones whose asserts read the count) replace the global operator new / delete;
+// release builds keep the standard library's and allocation_count() stays at zero:
+#ifndef NDEBUG
+
+//the other forms of operator new (array, nothrow) call this one by default:
+void *operator new(std::size_t size) {
+	count += 1;
+	if (size == 0) size = 1;
+	while (true) {
+		void *ptr = std::malloc(size);
+		if (ptr) return ptr;
+		std::new_handler handler = std::get_new_handler();
+		if (!handler) throw std::bad_alloc();
+		handler();
+	}
+}
+
+//(the other forms of operator delete call one of these by default)
+void operator delete(void *ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
+
+#endif //NDEBUG
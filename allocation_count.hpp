@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+ * Counts heap allocations made through operator new on the calling thread
+ *  (allocation_count.cpp replaces the global operator new / delete, in
+ *  builds without NDEBUG; with NDEBUG the count is always zero).
+ *
+ * Draw functions use it to check that, once their vertex arenas have grown
+ *  to their high-water size, building a frame doesn't allocate:
+ *
+ *   uint64_t before = allocation_count();
+ *   ... //build vertices
+ *   assert(allocation_count() == before || <an arena grew>);
+ */
+
+//number of operator new calls made so far by this thread:
+uint64_t allocation_count();
@@ -0,0 +1,395 @@
+//Headless micro-benchmarks for game logic.
+//
+//usage: bench [name ...]   (runs every benchmark if no names are given)
+
+#include "TankSim.hpp"
+#include "aabb_overlap.hpp"
+#include "SwarmSim.hpp"
+#include "MultiBallSim.hpp"
+#include "TankBot.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <random>
+#include <cstring>
+#include <cmath>
+
+//seconds since an arbitrary point:
+static double now() {
+	return std::chrono::duration< double >(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+}
+
+//TankSim::update cost as the number of rows of enemies on screen grows:
+// (rows live in a ring and move by bumping a counter, so this should stay flat)
+static void bench_rows() {
+	std::cout << "rows: ns per TankSim::update (every update is a movement tick)\n";
+	std::cout << std::setw(10) << "rows" << std::setw(14) << "ns/update" << "\n";
+	for (float court_height : { 7.0f, 28.0f, 112.0f, 448.0f, 1792.0f, 7168.0f }) {
+		TankSim sim(glm::vec2(3.0f, court_height));
+		//(warm up so the ring is at its steady-state size)
+		uint32_t warmup = uint32_t(2.0f * court_height / sim.enemy_step) + 16;
+		uint32_t updates = 200000;
+		uint64_t row_total = 0;
+		double before = 0.0;
+		for (uint32_t i = 0; i < warmup + updates; ++i) {
+			if (i == warmup) before = now();
+			//always longer than movement_interval, so enemies move every update:
+			sim.update(1.0f);
+			//keep playing even if the (idle) player gets hit:
+			sim.game_freeze = false;
+			if (i >= warmup) row_total += sim.rows.size();
+		}
+		double after = now();
+		std::cout << std::setw(10) << row_total / updates
+		          << std::setw(14) << std::fixed << std::setprecision(1) << (after - before) / updates * 1e9 << "\n";
+		std::cout.unsetf(std::ios::fixed);
+	}
+}
+
+//TankSim collision cost as the court widens to many lanes, with the bullet pool kept full:
+// (lane buckets mean each bullet only looks at its own lane, so ns per entity should stay flat)
+static void bench_lanes() {
+	std::cout << "lanes: ns per TankSim::update with a full bullet pool\n";
+	std::cout << std::setw(10) << "lanes" << std::setw(10) << "enemies" << std::setw(10) << "bullets"
+	          << std::setw(14) << "ns/update" << std::setw(14) << "ns/entity" << "\n";
+	for (uint32_t lanes : { 3, 8, 16, 32, 64 }) {
+		TankSim sim(glm::vec2(float(lanes), 112.0f));
+		std::mt19937 mt;
+		std::uniform_int_distribution< uint32_t > lane_dist(0, sim.lane_count - 1);
+		std::uniform_real_distribution< float > y_dist(-sim.court_radius.y, sim.court_radius.y);
+
+		uint32_t warmup = 1000;
+		uint32_t updates = 100000;
+		uint64_t enemy_total = 0, bullet_total = 0;
+		double elapsed = 0.0;
+		for (uint32_t i = 0; i < warmup + updates; ++i) {
+			//(refilling the pool isn't part of the measurement)
+			while (!sim.bullets.full()) {
+				sim.bullets.create(TankSim::BulletKind, glm::vec2(sim.lane_x(lane_dist(mt)), y_dist(mt)), sim.bullet_radius, sim.bullet_speed);
+			}
+			uint32_t bullets = sim.bullets.size();
+			double before = now();
+			sim.update(0.05f);
+			double after = now();
+			sim.game_freeze = false;
+			if (i >= warmup) {
+				elapsed += after - before;
+				enemy_total += sim.enemy_count;
+				bullet_total += bullets;
+			}
+		}
+		std::cout << std::setw(10) << sim.lane_count
+		          << std::setw(10) << enemy_total / updates
+		          << std::setw(10) << bullet_total / updates
+		          << std::fixed << std::setprecision(1)
+		          << std::setw(14) << elapsed / updates * 1e9
+		          << std::setw(14) << elapsed / (enemy_total + bullet_total) * 1e9 << "\n";
+		std::cout.unsetf(std::ios::fixed);
+	}
+}
+
+//one box against N boxes: batch SoA kernel vs. the per-pair lambda used in TankSim/PongMode:
+static void bench_aabb() {
+	std::cout << "aabb: ns per box tested (one query box vs. N boxes; kernel path: " << aabb_overlap_path() << ")\n";
+	std::cout << std::setw(10) << "N" << std::setw(12) << "lambda" << std::setw(12) << "scalar" << std::setw(12) << "kernel" << std::setw(10) << "hits" << "\n";
+
+	auto rect_a_vs_b = [](glm::vec2 const& a_pos, glm::vec2 const& a_rad, glm::vec2 const& b_pos, glm::vec2 const& b_rad) {
+		//compute area of overlap:
+		glm::vec2 min = glm::max(a_pos - a_rad, b_pos - b_rad);
+		glm::vec2 max = glm::min(a_pos + a_rad, b_pos + b_rad);
+
+		//if no overlap, no collision:
+		if (min.x > max.x || min.y > max.y) return false;
+		return true;
+	};
+
+	std::mt19937 mt;
+	std::uniform_real_distribution< float > pos_dist(-100.0f, 100.0f);
+	std::uniform_real_distribution< float > rad_dist(0.1f, 1.0f);
+
+	for (uint32_t count : { 100, 1000, 10000, 100000, 1000000 }) {
+		std::vector< glm::vec2 > positions(count), radii(count);
+		std::vector< float > xs(count), ys(count), rxs(count), rys(count);
+		for (uint32_t i = 0; i < count; ++i) {
+			positions[i] = glm::vec2(pos_dist(mt), pos_dist(mt));
+			radii[i] = glm::vec2(rad_dist(mt), rad_dist(mt));
+			xs[i] = positions[i].x; ys[i] = positions[i].y;
+			rxs[i] = radii[i].x; rys[i] = radii[i].y;
+		}
+		AABBSoA set;
+		set.x = xs.data(); set.y = ys.data(); set.rx = rxs.data(); set.ry = rys.data();
+		set.count = count;
+
+		//a big query box, so a good fraction of boxes hit:
+		glm::vec2 center = glm::vec2(10.0f, -5.0f);
+		glm::vec2 radius = glm::vec2(30.0f, 40.0f);
+
+		std::vector< uint64_t > lambda_hits(aabb_mask_words(count)), scalar_hits(lambda_hits.size()), kernel_hits(lambda_hits.size());
+		uint32_t reps = std::max(1u, 20000000u / count);
+
+		double before = now();
+		for (uint32_t r = 0; r < reps; ++r) {
+			std::fill(lambda_hits.begin(), lambda_hits.end(), uint64_t(0));
+			for (uint32_t i = 0; i < count; ++i) {
+				if (rect_a_vs_b(center, radius, positions[i], radii[i])) lambda_hits[i / 64] |= uint64_t(1) << (i % 64);
+			}
+		}
+		double lambda_time = now() - before;
+
+		before = now();
+		for (uint32_t r = 0; r < reps; ++r) aabb_overlap_mask_scalar(center, radius, set, scalar_hits.data());
+		double scalar_time = now() - before;
+
+		uint32_t found = 0;
+		before = now();
+		for (uint32_t r = 0; r < reps; ++r) found = aabb_overlap_mask(center, radius, set, kernel_hits.data());
+		double kernel_time = now() - before;
+
+		if (lambda_hits != scalar_hits || lambda_hits != kernel_hits) {
+			std::cout << "ERROR: hit masks differ at N = " << count << "\n";
+		}
+
+		//a batch of queries must give each query the mask the scalar path gives it alone:
+		glm::vec2 const batch_centers[3] = { center, glm::vec2(-60.0f, 30.0f), glm::vec2(0.0f, 0.0f) };
+		glm::vec2 const batch_radii[3] = { radius, glm::vec2(5.0f, 5.0f), glm::vec2(100.0f, 0.5f) };
+		size_t words = lambda_hits.size();
+		std::vector< uint64_t > batch_hits(3 * words);
+		uint32_t batch_found = aabb_overlap_masks(3, batch_centers, batch_radii, set, batch_hits.data());
+		uint32_t single_found = 0;
+		bool batch_match = true;
+		for (uint32_t q = 0; q < 3; ++q) {
+			single_found += aabb_overlap_mask_scalar(batch_centers[q], batch_radii[q], set, scalar_hits.data());
+			if (!std::equal(scalar_hits.begin(), scalar_hits.end(), batch_hits.begin() + q * words)) batch_match = false;
+		}
+		if (!batch_match || batch_found != single_found) {
+			std::cout << "ERROR: batched hit masks differ at N = " << count << "\n";
+		}
+
+		double tests = double(reps) * count;
+		std::cout << std::setw(10) << count << std::fixed << std::setprecision(2)
+		          << std::setw(12) << lambda_time / tests * 1e9
+		          << std::setw(12) << scalar_time / tests * 1e9
+		          << std::setw(12) << kernel_time / tests * 1e9
+		          << std::setw(10) << found << "\n";
+		std::cout.unsetf(std::ios::fixed);
+	}
+}
+
+//SwarmSim with 100k moving enemies and a 10k bullet pool (refilled every tick):
+static void bench_swarm() {
+	SwarmSim sim(100000, 10000, glm::vec2(80.0f, 60.0f));
+	sim.firing = true;
+	sim.fire_rate = 1e9f; //refill the bullet pool every tick
+
+	uint32_t warmup = 60;
+	uint32_t updates = 600;
+	SwarmSim::Timings sum;
+	double worst = 0.0;
+	uint64_t bullet_total = 0;
+	for (uint32_t i = 0; i < warmup + updates; ++i) {
+		//sweep the player back and forth:
+		sim.player_move = ((i / 120) % 2 ? 1.0f : -1.0f);
+		sim.update(1.0f / 120.0f);
+		if (i < warmup) continue;
+		sum.move += sim.timings.move;
+		sum.grid += sim.timings.grid;
+		sum.collide += sim.timings.collide;
+		sum.cleanup += sim.timings.cleanup;
+		worst = std::max(worst, sim.timings.total());
+		bullet_total += sim.bullet_count;
+	}
+
+	std::cout << "swarm: " << sim.enemy_count << " enemies, " << sim.max_bullets << " bullet pool, "
+	          << sim.grid_w << "x" << sim.grid_h << " grid (cell size " << sim.cell_size << ")\n";
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "  ms per update:  move " << sum.move / updates * 1e3
+	          << "  grid " << sum.grid / updates * 1e3
+	          << "  collide " << sum.collide / updates * 1e3
+	          << "  cleanup " << sum.cleanup / updates * 1e3
+	          << "  total " << sum.total() / updates * 1e3
+	          << "  (worst " << worst * 1e3 << ")\n";
+	std::cout.unsetf(std::ios::fixed);
+	std::cout << "  " << sim.enemies_shot << " enemies shot, " << bullet_total / updates << " bullets alive after an average update\n";
+}
+
+//MultiBallSim with 50k balls: integrate() vs integrate_scalar(), then whole updates:
+static void bench_multiball() {
+	uint32_t const balls = 50000;
+	uint32_t const updates = 2000;
+	float const tick = 1.0f / 120.0f;
+
+	//same balls, moved by each integrator; results must match exactly:
+	MultiBallSim simd(balls, glm::vec2(7.0f, 5.0f), 1);
+	MultiBallSim scalar(balls, glm::vec2(7.0f, 5.0f), 1);
+
+	double before = now();
+	for (uint32_t i = 0; i < updates; ++i) simd.integrate(tick);
+	double simd_time = (now() - before) / updates;
+
+	before = now();
+	for (uint32_t i = 0; i < updates; ++i) scalar.integrate_scalar(tick);
+	double scalar_time = (now() - before) / updates;
+
+	bool match = simd.left_points == scalar.left_points && simd.right_points == scalar.right_points
+		&& std::memcmp(simd.ball_x.data(), scalar.ball_x.data(), balls * sizeof(float)) == 0
+		&& std::memcmp(simd.ball_y.data(), scalar.ball_y.data(), balls * sizeof(float)) == 0
+		&& std::memcmp(simd.ball_vx.data(), scalar.ball_vx.data(), balls * sizeof(float)) == 0
+		&& std::memcmp(simd.ball_vy.data(), scalar.ball_vy.data(), balls * sizeof(float)) == 0;
+
+	//full updates, with the left paddle following a slow sine:
+	MultiBallSim sim(balls, glm::vec2(7.0f, 5.0f), 2);
+	MultiBallSim::Timings sum;
+	double worst = 0.0;
+	for (uint32_t i = 0; i < updates; ++i) {
+		sim.left_paddle.y = 4.0f * std::sin(i * tick);
+		sim.update(tick);
+		sum.integrate += sim.timings.integrate;
+		sum.paddles += sim.timings.paddles;
+		worst = std::max(worst, sim.timings.total());
+	}
+
+	std::cout << "multiball: " << balls << " balls, " << updates << " updates (" << MultiBallSim::integrate_path() << " integrator)\n";
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "  ms per integrate:  " << MultiBallSim::integrate_path() << " " << simd_time * 1e3
+	          << "  scalar " << scalar_time * 1e3 << "  (x" << std::setprecision(2) << scalar_time / simd_time << ")\n";
+	std::cout << std::setprecision(3);
+	std::cout << "  ms per update:  integrate " << sum.integrate / updates * 1e3
+	          << "  paddles " << sum.paddles / updates * 1e3
+	          << "  total " << sum.total() / updates * 1e3
+	          << "  (worst " << worst * 1e3 << ")\n";
+	std::cout.unsetf(std::ios::fixed);
+	std::cout << "  score " << sim.left_points << " : " << sim.right_points << ", " << sim.paddle_hits << " paddle hits\n";
+	std::cout << "  " << MultiBallSim::integrate_path() << " integrator " << (match ? "matches" : "DOES NOT match") << " scalar integrator\n";
+}
+
+//one generator on the TankSim spawn path: each new row draws a count and a
+// lane from freshly-built distributions (just like TankSim::add_enemies):
+template< typename Rng >
+static void bench_rng_one(char const *name) {
+	uint32_t const rows = 10000000;
+	uint32_t const lanes = 3;
+	uint64_t sink = 0; //(keeps the optimizer from discarding the draws)
+
+	double before = now();
+	for (uint32_t i = 0; i < 1000; ++i) {
+		Rng rng(i);
+		sink += rng();
+	}
+	double seed_time = (now() - before) / 1000;
+
+	Rng rng(1);
+	before = now();
+	for (uint32_t i = 0; i < rows; ++i) {
+		std::uniform_int_distribution<> num_dist(1, 3);
+		std::uniform_int_distribution<> pos_dist(0, lanes - 1);
+		sink += num_dist(rng);
+		sink += pos_dist(rng);
+	}
+	double spawn_time = (now() - before) / rows;
+
+	before = now();
+	for (uint32_t i = 0; i < rows; ++i) {
+		sink += rng();
+	}
+	double raw_time = (now() - before) / rows;
+
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << std::setw(12) << name
+	          << std::setw(12) << seed_time * 1e9
+	          << std::setw(12) << spawn_time * 1e9
+	          << std::setw(12) << raw_time * 1e9
+	          << std::setw(10) << sizeof(Rng)
+	          << "   (" << (sink & 0xff) << ")\n";
+	std::cout.unsetf(std::ios::fixed);
+}
+
+//std::mt19937 vs the Pcg32 generator that game modes own (GameRng):
+static void bench_rng() {
+	std::cout << "rng: ns to seed, ns per spawned row (two distribution draws), ns per raw draw\n";
+	std::cout << std::setw(12) << "generator" << std::setw(12) << "seed" << std::setw(12) << "spawn" << std::setw(12) << "raw" << std::setw(10) << "bytes" << "\n";
+	bench_rng_one< std::mt19937 >("mt19937");
+	bench_rng_one< Pcg32 >("Pcg32");
+}
+
+//TankSim::save + TankSim::restore, as used for rollback (rewind to a snapshot and re-simulate):
+static void bench_snapshot() {
+	TankSim sim(glm::vec2(3.0f, 7.0f), 1);
+	TankBot bot;
+	for (uint32_t t = 0; t < 1200; ++t) { //(get some rows and bullets on screen)
+		bot.act(sim);
+		sim.update(1.0f / 120.0f);
+	}
+
+	TankSnapshot snapshot;
+	uint32_t const reps = 2000000;
+
+	double before = now();
+	for (uint32_t i = 0; i < reps; ++i) {
+		sim.save(&snapshot);
+	}
+	double save_time = (now() - before) / reps;
+
+	before = now();
+	for (uint32_t i = 0; i < reps; ++i) {
+		sim.restore(snapshot);
+	}
+	double restore_time = (now() - before) / reps;
+
+	//rollback check: re-simulating from a restored snapshot (in a different sim) must land in exactly the same state:
+	TankSnapshot start, ahead, replayed;
+	sim.save(&start);
+	for (uint32_t t = 0; t < 6000 && !sim.game_freeze; ++t) {
+		bot.act(sim);
+		sim.update(1.0f / 120.0f);
+	}
+	sim.save(&ahead);
+
+	TankSim other(glm::vec2(3.0f, 7.0f), 12345);
+	other.restore(start);
+	for (uint32_t t = 0; t < 6000 && !other.game_freeze; ++t) {
+		bot.act(other);
+		other.update(1.0f / 120.0f);
+	}
+	other.save(&replayed);
+	bool match = (std::memcmp(&ahead, &replayed, sizeof(TankSnapshot)) == 0);
+
+	std::cout << "snapshot: " << sizeof(TankSnapshot) << " byte snapshot holding " << snapshot.row_count << " rows, " << snapshot.bullet_count << " bullets\n";
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << "  save " << save_time * 1e9 << " ns, restore " << restore_time * 1e9 << " ns, save + restore " << (save_time + restore_time) * 1e9 << " ns\n";
+	std::cout.unsetf(std::ios::fixed);
+	std::cout << "  re-simulating from a restored snapshot " << (match ? "matches" : "DOES NOT match") << " the original (" << ahead.ticks - start.ticks << " ticks)\n";
+}
+
+int main(int argc, char **argv) {
+	std::vector< std::pair< std::string, std::function< void() > > > benchmarks = {
+		{"rows", bench_rows},
+		{"lanes", bench_lanes},
+		{"aabb", bench_aabb},
+		{"swarm", bench_swarm},
+		{"multiball", bench_multiball},
+		{"rng", bench_rng},
+		{"snapshot", bench_snapshot},
+	};
+
+	std::vector< std::string > names(argv + 1, argv + argc);
+	bool ran = false;
+	for (auto const &b : benchmarks) {
+		if (names.empty() || std::find(names.begin(), names.end(), b.first) != names.end()) {
+			b.second();
+			std::cout << std::endl;
+			ran = true;
+		}
+	}
+	if (!ran) {
+		std::cerr << "usage: bench [name ...]\n  benchmarks:";
+		for (auto const &b : benchmarks) std::cerr << " " << b.first;
+		std::cerr << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/*
+ * Bit tricks for walking bitmasks (lane masks, aabb_overlap hit masks).
+ *
+ * To visit each set bit, lowest first:
+ *   for (uint64_t left = bits; left; left &= left - 1) {
+ *     uint32_t b = lowest_set_bit(left);
+ *     ...
+ *   }
+ */
+
+//index of the lowest set bit of 'bits' (a count-trailing-zeros instruction); 'bits' must not be zero:
+inline uint32_t lowest_set_bit(uint64_t bits) {
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward64(&index, bits);
+	return uint32_t(index);
+#else
+	return uint32_t(__builtin_ctzll(bits));
+#endif
+}
@@ -7,12 +7,30 @@
 //The 'NewMode' mode for the assignment
 #include "NewMode.hpp"
 
+//The 'SwarmMode' mode is a large-entity variant of NewMode:
+#include "SwarmMode.hpp"
+
+//The 'MultiBallMode' mode is a many-ball variant of PongMode:
+#include "MultiBallMode.hpp"
+
+//The 'RectBenchMode' mode times the two ways of drawing rectangles:
+#include "RectBenchMode.hpp"
+
+//Renderer2D declares "Renderer2D::current", the renderer every mode draws through (created here along with the OpenGL context):
+#include "Renderer2D.hpp"
+
 //GL.hpp will include a non-namespace-polluting set of opengl prototypes:
 #include "GL.hpp"
 
 //for screenshots:
 #include "load_save_png.hpp"
 
+//for running update() at a fixed rate:
+#include "FixedTimestep.hpp"
+
+//for recording and replaying sessions:
+#include "InputLog.hpp"
+
 //Includes for libSDL:
 #include <SDL.h>
 
@@ -22,6 +40,8 @@
 #include <stdexcept>
 #include <memory>
 #include <algorithm>
+#include <string>
+#include <cstdlib>
 
 int main(int argc, char **argv) {
 #ifdef _WIN32
@@ -29,6 +49,82 @@ int main(int argc, char **argv) {
 	try {
 #endif
 
+	//------------  command line ------------
+
+	//which mode to start in:
+	enum { StartNew, StartSwarm, StartMultiBall, StartRectBench } start_mode = StartNew;
+	//seed for the mode's random number generator (same seed => same enemies):
+	uint32_t seed = 0;
+	//record the session to this file:
+	std::string record_file;
+	//replay the session from this file instead of taking input:
+	std::string replay_file;
+	//also print the score to the console (it is always drawn on screen):
+	bool console_score = false;
+	//let TankBot play, searching this many enemy movements ahead:
+	uint32_t bot_depth = 0;
+	//make enemy rows on a background thread, up to this many ahead (0 = make each when it spawns):
+	uint32_t rows_ahead = 0;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "--swarm") {
+			start_mode = StartSwarm;
+		} else if (arg == "--multiball") {
+			start_mode = StartMultiBall;
+		} else if (arg == "--rect-bench") {
+			start_mode = StartRectBench;
+		} else if (arg == "--seed" && i + 1 < argc) {
+			seed = uint32_t(std::strtoul(argv[++i], nullptr, 10));
+		} else if (arg == "--record" && i + 1 < argc) {
+			record_file = argv[++i];
+		} else if (arg == "--replay" && i + 1 < argc) {
+			replay_file = argv[++i];
+		} else if (arg == "--console-score") {
+			console_score = true;
+		} else if (arg == "--bot" && i + 1 < argc) {
+			bot_depth = std::max(1u, uint32_t(std::strtoul(argv[++i], nullptr, 10)));
+		} else if (arg == "--rows-ahead" && i + 1 < argc) {
+			rows_ahead = uint32_t(std::strtoul(argv[++i], nullptr, 10));
+		} else {
+			std::cerr << "usage: " << argv[0] << " [--swarm | --multiball | --rect-bench] [--seed N] [--record FILE | --replay FILE] [--console-score] [--bot DEPTH] [--rows-ahead N]" << std::endl;
+			return 1;
+		}
+	}
+	if (record_file != "" && replay_file != "") {
+		std::cerr << "Can't both record and replay a session." << std::endl;
+		return 1;
+	}
+	if (bot_depth && (record_file != "" || replay_file != "")) {
+		//(the bot's search stops on a time budget, so its play isn't repeatable)
+		std::cerr << "Can't record or replay a session the bot plays." << std::endl;
+		return 1;
+	}
+	if (start_mode == StartRectBench && (record_file != "" || replay_file != "")) {
+		std::cerr << "Can't record or replay the rectangle benchmark." << std::endl;
+		return 1;
+	}
+	if (rows_ahead && (record_file != "" || replay_file != "")) {
+		//(background rows are a different sequence than the seed gives otherwise, and logs don't say which was used)
+		std::cerr << "Can't record or replay a session with --rows-ahead." << std::endl;
+		return 1;
+	}
+
+	//a replay restarts the recorded session with the recorded mode and seed:
+	InputLog log;
+	if (replay_file != "") {
+		try {
+			log.load(replay_file);
+		} catch (std::exception const &e) {
+			std::cerr << e.what() << std::endl;
+			return 1;
+		}
+		if (log.mode == StartSwarm) start_mode = StartSwarm;
+		else if (log.mode == StartMultiBall) start_mode = StartMultiBall;
+		else start_mode = StartNew;
+		seed = log.seed;
+	}
+
 	//------------  initialization ------------
 
 	//Initialize SDL library:
@@ -52,7 +148,7 @@ int main(int argc, char **argv) {
 	SDL_Window *window = SDL_CreateWindow(
 		"Raging Tank", //TODO: remember to set a title for your game!
 		SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
-		480, 480, //TODO: modify window size if you'd like
+		(replay_file != "" ? int(log.window_size.x) : 480), (replay_file != "" ? int(log.window_size.y) : 480), //TODO: modify window size if you'd like
 		SDL_WINDOW_OPENGL
 		| SDL_WINDOW_RESIZABLE //uncomment to allow resizing
 		| SDL_WINDOW_ALLOW_HIGHDPI //uncomment for full resolution on high-DPI screens
@@ -79,18 +175,38 @@ int main(int argc, char **argv) {
 	init_GL();
 
 	//Set VSYNC + Late Swap (prevents crazy FPS):
-	if (SDL_GL_SetSwapInterval(-1) != 0) {
+	// (replays and benchmarks turn vsync off so they run as fast as possible)
+	if (replay_file != "" || start_mode == StartRectBench) {
+		if (SDL_GL_SetSwapInterval(0) != 0) {
+			std::cerr << "NOTE: couldn't turn off vsync (" << SDL_GetError() << ")." << std::endl;
+		}
+	} else if (SDL_GL_SetSwapInterval(-1) != 0) {
 		std::cerr << "NOTE: couldn't set vsync + late swap tearing (" << SDL_GetError() << ")." << std::endl;
 		if (SDL_GL_SetSwapInterval(1) != 0) {
 			std::cerr << "NOTE: couldn't set vsync (" << SDL_GetError() << ")." << std::endl;
 		}
 	}
 
+	//Shaders, vertex arrays and buffers shared by every mode (created once per context):
+	Renderer2D::current.reset(new Renderer2D());
+
 	//Hide mouse cursor (note: showing can be useful for debugging):
 	//SDL_ShowCursor(SDL_DISABLE);
 
 	//------------ create game mode + make current --------------
-	Mode::set_current(std::make_shared< NewMode >());
+	if (start_mode == StartSwarm) {
+		Mode::set_current(std::make_shared< SwarmMode >(20000, 2000, seed));
+	} else if (start_mode == StartMultiBall) {
+		Mode::set_current(std::make_shared< MultiBallMode >(5000, seed));
+	} else if (start_mode == StartRectBench) {
+		Mode::set_current(std::make_shared< RectBenchMode >());
+	} else {
+		std::shared_ptr< NewMode > mode = std::make_shared< NewMode >(seed, rows_ahead);
+		mode->console_score = console_score;
+		mode->bot_playing = (bot_depth != 0);
+		mode->bot.max_depth = bot_depth;
+		Mode::set_current(mode);
+	}
 
 	//------------ main loop ------------
 
@@ -109,14 +225,76 @@ int main(int argc, char **argv) {
 	};
 	on_resize();
 
+	//update() is called in fixed-size ticks; leftover time is passed to draw() for interpolation:
+	FixedTimestep timestep;
+
+	if (record_file != "") {
+		log.mode = start_mode;
+		log.seed = seed;
+		log.window_size = window_size;
+		log.tick = timestep.tick;
+		log.max_ticks_per_frame = timestep.max_ticks_per_frame;
+	}
+
+	//replays use the recorded timestep settings and window size, whatever the actual window is doing:
+	uint32_t replay_frame = 0;
+	uint32_t replay_event = 0;
+	glm::uvec2 replay_window_size = log.window_size;
+	if (replay_file != "") {
+		timestep.tick = log.tick;
+		timestep.max_ticks_per_frame = log.max_ticks_per_frame;
+	}
+	auto replay_start = std::chrono::high_resolution_clock::now();
+
+	//status of the mode when the session ended (for recordings and replays to compare):
+	std::string final_status;
+	auto end_session = [&](){
+		final_status = Mode::current->status();
+		Mode::set_current(nullptr);
+	};
+
 	//This will loop until the current mode is set to null:
 	while (Mode::current) {
 		//every pass through the game loop creates one frame of output
 		//  by performing three steps:
 
-		{ //(1) process any events that are pending
+		if (replay_file != "") { //(1, replay) ignore live input and feed in the recorded events instead
 			static SDL_Event evt;
 			while (SDL_PollEvent(&evt) == 1) {
+				if (evt.type == SDL_WINDOWEVENT && evt.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+					on_resize();
+				} else if (evt.type == SDL_QUIT) {
+					std::cout << "Replay stopped early." << std::endl;
+					end_session();
+					break;
+				}
+			}
+			if (!Mode::current) break;
+
+			if (replay_frame == log.frames.size()) {
+				end_session();
+				break;
+			}
+			InputLog::Frame const &frame = log.frames[replay_frame];
+			for (uint32_t e = 0; e < frame.event_count; ++e) {
+				SDL_Event logged = InputLog::unpack(log.events[replay_event + e]);
+				if (logged.type == SDL_WINDOWEVENT && logged.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+					replay_window_size = glm::uvec2(logged.window.data1, logged.window.data2);
+				}
+				if (Mode::current->handle_event(logged, replay_window_size)) {
+					// mode handled it
+				} else if (logged.type == SDL_QUIT) {
+					end_session();
+					break;
+				}
+			}
+			if (!Mode::current) break;
+		} else { //(1) process any events that are pending
+			static SDL_Event evt;
+			while (SDL_PollEvent(&evt) == 1) {
+				if (record_file != "") {
+					log.add_event(evt);
+				}
 				//handle resizing:
 				if (evt.type == SDL_WINDOWEVENT && evt.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
 					on_resize();
@@ -125,7 +303,11 @@ int main(int argc, char **argv) {
 				if (Mode::current && Mode::current->handle_event(evt, window_size)) {
 					// mode handled it; great
 				} else if (evt.type == SDL_QUIT) {
-					Mode::set_current(nullptr);
+					if (record_file != "") {
+						//close the last frame so the replay sees the quit, too:
+						log.end_frame(0.0f);
+					}
+					end_session();
 					break;
 				} else if (evt.type == SDL_KEYDOWN && evt.key.keysym.sym == SDLK_PRINTSCREEN) {
 					// --- screenshot key ---
@@ -146,23 +328,34 @@ int main(int argc, char **argv) {
 			if (!Mode::current) break;
 		}
 
-		{ //(2) call the current mode's "update" function to deal with elapsed time:
+		{ //(2) call the current mode's "update" function once per fixed tick of elapsed time:
 			auto current_time = std::chrono::high_resolution_clock::now();
 			static auto previous_time = current_time;
 			float elapsed = std::chrono::duration< float >(current_time - previous_time).count();
 			previous_time = current_time;
 
-			//if frames are taking a very long time to process,
-			//lag to avoid spiral of death:
-			elapsed = std::min(0.1f, elapsed);
+			if (replay_file != "") {
+				//replays use the recorded frame times, however long this frame actually took:
+				elapsed = log.frames[replay_frame].elapsed;
+				replay_event += log.frames[replay_frame].event_count;
+				replay_frame += 1;
+			} else if (record_file != "") {
+				log.end_frame(elapsed);
+			}
 
-			Mode::current->update(elapsed);
+			//if frames are taking a very long time to process, timestep will only catch up
+			// by max_ticks_per_frame ticks and drop the rest (counted in ticks_dropped):
+			uint32_t ticks = timestep.advance(elapsed);
+			for (uint32_t i = 0; i < ticks; ++i) {
+				Mode::current->update(timestep.tick);
+				if (!Mode::current) break;
+			}
 			if (!Mode::current) break;
 		}
 
 		{ //(3) call the current mode's "draw" function to produce output:
 		
-			Mode::current->draw(drawable_size);
+			Mode::current->draw(drawable_size, timestep.alpha());
 		}
 
 		//Wait until the recently-drawn frame is shown before doing it all again:
@@ -172,13 +365,43 @@ int main(int argc, char **argv) {
 
 	//------------  teardown ------------
 
+	if (timestep.total_ticks_dropped) {
+		std::cout << "NOTE: dropped " << timestep.total_ticks_dropped << " of " << (timestep.total_ticks_run + timestep.total_ticks_dropped) << " update ticks to keep up." << std::endl;
+	}
+
+	int exit_code = 0;
+
+	if (record_file != "") {
+		log.status = final_status;
+		log.save(record_file);
+		std::cout << "Recorded " << log.frames.size() << " frames (" << log.events.size() << " events) to '" << record_file << "'; final status: " << log.status << std::endl;
+	}
+
+	if (replay_file != "") {
+		double seconds = std::chrono::duration< double >(std::chrono::high_resolution_clock::now() - replay_start).count();
+		std::cout << "Replayed " << replay_frame << " frames (" << timestep.total_ticks_run << " ticks) in " << seconds << " seconds: "
+		          << replay_frame / seconds << " frames per second." << std::endl;
+		if (final_status == log.status) {
+			std::cout << "Replay matches recording: " << final_status << std::endl;
+		} else {
+			std::cout << "Replay DOES NOT match recording!\n  recorded: " << log.status << "\n  replayed: " << final_status << std::endl;
+			exit_code = 1;
+		}
+	}
+
+	if (Renderer2D::current->frames) {
+		std::cout << "Renderer: " << Renderer2D::current->report() << "." << std::endl;
+		std::cout << "Vertex stream: " << Renderer2D::current->stream.report() << "." << std::endl;
+	}
+	Renderer2D::current.reset();
+
 	SDL_GL_DeleteContext(context);
 	context = 0;
 
 	SDL_DestroyWindow(window);
 	window = NULL;
 
-	return 0;
+	return exit_code;
 
 #ifdef _WIN32
 	} catch (std::exception const &e) {
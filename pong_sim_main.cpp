@@ -0,0 +1,201 @@
+//Headless tunneling check for PongSim: fires balls at extreme speeds and
+// long timesteps and checks, after every update, that no ball has passed
+// through a paddle or out of the court, and that no update ran out of
+// bounces and dropped time. Exits with status 1 if any did.
+//
+//usage: pong-sim [--seed N] [--balls N] [--steps N] [--matches N] [--reaction S] [--error E]
+//
+//Two checks are run at every speed and tick length:
+// - walls: both paddles are as tall as the court, so a ball can never get
+//   past one; its center must stay between them and no one may score.
+// - play: normal paddles, with the left one jumping to a random height every
+//   update (as the mouse can); the ball must stay in the court and must
+//   never be left overlapping a paddle.
+//
+//Afterwards it plays AI-vs-AI matches (both paddles run PongSim::AI with the
+// given reaction time and aim error) and reports scores and the AI's cost.
+
+#include "PongSim.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+//start a ball from somewhere in the middle of the court in a random direction:
+static void fire_ball(PongSim &sim, Pcg32 &rng) {
+	std::uniform_real_distribution< float > x_dist(-2.0f, 2.0f);
+	std::uniform_real_distribution< float > y_dist(-0.8f * sim.court_radius.y, 0.8f * sim.court_radius.y);
+	std::uniform_real_distribution< float > angle_dist(-1.2f, 1.2f); //(up to ~70 degrees from horizontal)
+	std::uniform_int_distribution< int > side_dist(0, 1);
+
+	float angle = angle_dist(rng);
+	float side = (side_dist(rng) ? 1.0f : -1.0f);
+	uint32_t b = sim.entities.at(sim.ball);
+	sim.entities.position[b] = glm::vec2(x_dist(rng), y_dist(rng));
+	sim.entities.previous[b] = sim.entities.position[b];
+	sim.entities.velocity[b] = glm::vec2(side * std::cos(angle), std::sin(angle));
+}
+
+int main(int argc, char **argv) {
+	uint32_t seed = 0;
+	uint32_t balls = 200;
+	uint32_t steps = 100;
+	uint32_t matches = 20;
+	PongSim::AI difficulty;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "--seed" && i + 1 < argc) {
+			seed = uint32_t(std::strtoul(argv[++i], nullptr, 10));
+		} else if (arg == "--balls" && i + 1 < argc) {
+			balls = uint32_t(std::strtoul(argv[++i], nullptr, 10));
+		} else if (arg == "--steps" && i + 1 < argc) {
+			steps = uint32_t(std::strtoul(argv[++i], nullptr, 10));
+		} else if (arg == "--matches" && i + 1 < argc) {
+			matches = uint32_t(std::strtoul(argv[++i], nullptr, 10));
+		} else if (arg == "--reaction" && i + 1 < argc) {
+			difficulty.reaction = std::strtof(argv[++i], nullptr);
+		} else if (arg == "--error" && i + 1 < argc) {
+			difficulty.error = std::strtof(argv[++i], nullptr);
+		} else {
+			std::cerr << "usage: pong-sim [--seed N] [--balls N] [--steps N] [--matches N] [--reaction S] [--error E]" << std::endl;
+			return 1;
+		}
+	}
+
+	Pcg32 rng(seed, 1);
+	const float slop = 1e-3f; //allowed error in positions (court units)
+
+	uint64_t failures = 0;
+
+	std::cout << "  points      speed      tick     check   updates   bounces/update   ns/update   failures\n";
+	//(ball speed is 4 * 2^(points / 4), so these run from 4 up to about 1e6 court units per second)
+	for (uint32_t points : {0, 16, 32, 48, 56, 64, 72}) {
+		for (float tick : {1.0f / 240.0f, 1.0f / 30.0f, 1.0f / 5.0f}) {
+			for (int check = 0; check < 2; ++check) {
+				bool walls = (check == 0);
+				uint64_t updates = 0;
+				uint64_t bounces = 0;
+				uint64_t failed = 0;
+				double seconds = 0.0;
+				float speed = 0.0f;
+
+				uint32_t row_balls = balls;
+				for (uint32_t n = 0; n < row_balls; ++n) {
+					PongSim sim(seed + n);
+					if (n == 0) {
+						//with walls, every court crossing is a paddle bounce, so fast rows with long ticks
+						// fire fewer balls (each of their updates is thousands of bounces):
+						sim.left_score = points;
+						float crossings = sim.speed_multiplier() * tick / (2.0f * sim.court_radius.x);
+						if (walls && crossings > 16.0f) row_balls = std::max(std::min(balls, 8u), uint32_t(balls * 16.0f / crossings));
+					}
+					if (walls) {
+						for (uint32_t i = 0; i < sim.entities.size(); ++i) {
+							if (sim.entities.kind[i] == PongSim::Paddle) sim.entities.radius[i].y = sim.court_radius.y;
+						}
+					}
+					fire_ball(sim, rng);
+
+					std::uniform_real_distribution< float > paddle_dist(-sim.court_radius.y, sim.court_radius.y);
+					bool ball_failed = false;
+					for (uint32_t s = 0; s < steps && !ball_failed; ++s) {
+						if (!walls) sim.set_left_paddle(paddle_dist(rng));
+						//(the ball's speed comes from the score, so it is put back every update)
+						sim.left_score = points / 2;
+						sim.right_score = points - points / 2;
+
+						speed = sim.speed_multiplier();
+						auto before = std::chrono::high_resolution_clock::now();
+						sim.update(tick);
+						seconds += std::chrono::duration< double >(std::chrono::high_resolution_clock::now() - before).count();
+						updates += 1;
+						bounces += sim.bounces;
+
+						uint32_t b = sim.entities.at(sim.ball);
+						glm::vec2 ball = sim.entities.position[b];
+						glm::vec2 ball_radius = sim.entities.radius[b];
+						glm::vec2 limit = sim.court_radius - ball_radius + slop;
+						if (!(std::abs(ball.x) <= limit.x && std::abs(ball.y) <= limit.y)) ball_failed = true;
+
+						for (uint32_t i = 0; i < sim.entities.size(); ++i) {
+							if (sim.entities.kind[i] != PongSim::Paddle) continue;
+							glm::vec2 paddle = sim.entities.position[i];
+							glm::vec2 reach = sim.entities.radius[i] + ball_radius;
+							if (walls) {
+								//the ball must be on the court side of this paddle:
+								float inner = paddle.x + (paddle.x < 0.0f ? reach.x : -reach.x);
+								if (paddle.x < 0.0f ? ball.x < inner - slop : ball.x > inner + slop) ball_failed = true;
+							} else {
+								//the ball must not be inside this paddle:
+								glm::vec2 depth = reach - glm::abs(ball - paddle);
+								if (depth.x > slop && depth.y > slop) ball_failed = true;
+							}
+						}
+						if (walls && (sim.left_score + sim.right_score != points)) ball_failed = true;
+						if (sim.dropped_seconds > 0.0) ball_failed = true;
+					}
+					if (ball_failed) failed += 1;
+				}
+
+				std::cout << std::setw(8) << points << std::setw(11) << speed
+				          << std::setw(10) << std::setprecision(4) << tick << std::setw(10) << (walls ? "walls" : "play")
+				          << std::setw(10) << updates << std::setw(17) << std::setprecision(3) << double(bounces) / updates
+				          << std::setw(12) << std::setprecision(4) << seconds / updates * 1e9 << std::setw(11) << failed << "\n";
+				failures += failed;
+			}
+		}
+	}
+
+	if (matches) {
+		//AI vs AI, one minute of play per match:
+		float const tick = 1.0f / 120.0f;
+		uint32_t const match_steps = 120 * 60;
+		uint64_t left_points = 0, right_points = 0, predictions = 0, updates = 0;
+		double seconds = 0.0;
+		for (uint32_t m = 0; m < matches; ++m) {
+			PongSim sim(seed + m);
+			sim.left_ai_playing = true;
+			sim.left_ai = difficulty;
+			sim.right_ai = difficulty;
+			auto before = std::chrono::high_resolution_clock::now();
+			for (uint32_t s = 0; s < match_steps; ++s) {
+				sim.update(tick);
+			}
+			seconds += std::chrono::duration< double >(std::chrono::high_resolution_clock::now() - before).count();
+			updates += match_steps;
+			left_points += sim.left_score;
+			right_points += sim.right_score;
+			predictions += sim.left_ai.predictions + sim.right_ai.predictions;
+		}
+
+		//AI alone, with the ball changing direction every 60 calls (about twice a second at 120 updates per second):
+		PongSim sim(seed);
+		uint32_t const calls = 10000000;
+		uint32_t b = sim.entities.at(sim.ball);
+		auto before = std::chrono::high_resolution_clock::now();
+		for (uint32_t c = 0; c < calls; ++c) {
+			if (c % 60 == 0) sim.entities.velocity[b] = -sim.entities.velocity[b] + glm::vec2(0.0f, 0.01f);
+			sim.update_ai(sim.right_ai, sim.right_paddle, tick);
+		}
+		double ai_seconds = std::chrono::duration< double >(std::chrono::high_resolution_clock::now() - before).count();
+
+		std::cout << "AI vs AI (reaction " << difficulty.reaction << " s, error " << difficulty.error << "): "
+		          << matches << " one-minute matches, points " << left_points << " : " << right_points
+		          << ", " << double(predictions) / (matches * 60.0) << " predictions per second\n";
+		std::cout << "  " << seconds / updates * 1e9 << " ns per update, " << ai_seconds / calls * 1e9 << " ns per AI paddle update"
+		          << " (" << sim.right_ai.predictions << " predictions in " << calls << " calls)\n";
+	}
+
+	if (failures) {
+		std::cout << failures << " balls tunneled, escaped, or dropped time." << std::endl;
+		return 1;
+	}
+	std::cout << "No ball tunneled, escaped, or dropped time." << std::endl;
+	return 0;
+}
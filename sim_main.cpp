@@ -0,0 +1,135 @@
+//Headless driver for TankSim: steps the game rules as fast as possible
+// with no window or OpenGL context, for benchmarking and soak-testing.
+//
+//usage: tank-sim [--ticks N] [--tick SECONDS] [--seed N] [--idle | --bot DEPTH [--bot-nodes N]] [--rows-ahead N]
+//
+//--rows-ahead N has a RowGenerator thread make enemy rows up to N ahead.
+
+#include "TankSim.hpp"
+#include "TankBot.hpp"
+#include "RowGenerator.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <memory>
+#include <cstdlib>
+#include <algorithm>
+
+int main(int argc, char **argv) {
+	uint64_t ticks = 10000000;
+	float tick = 1.0f / 120.0f;
+	uint32_t seed = 0;
+	bool idle = false; //don't press any keys (games end quickly)
+	bool use_bot = false; //let TankBot play instead of pressing random keys
+	TankBot bot;
+	bot.budget_seconds = 0.0f; //(headless runs use a node budget, if any, so they are repeatable)
+	uint32_t rows_ahead = 0; //0 => rows come from the sim's own generator
+
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "--ticks" && i + 1 < argc) {
+			ticks = std::strtoull(argv[++i], nullptr, 10);
+		} else if (arg == "--tick" && i + 1 < argc) {
+			tick = std::strtof(argv[++i], nullptr);
+		} else if (arg == "--seed" && i + 1 < argc) {
+			seed = uint32_t(std::strtoul(argv[++i], nullptr, 10));
+		} else if (arg == "--idle") {
+			idle = true;
+		} else if (arg == "--bot" && i + 1 < argc) {
+			use_bot = true;
+			bot.max_depth = uint32_t(std::strtoul(argv[++i], nullptr, 10));
+		} else if (arg == "--bot-nodes" && i + 1 < argc) {
+			bot.budget_nodes = std::strtoull(argv[++i], nullptr, 10);
+		} else if (arg == "--rows-ahead" && i + 1 < argc) {
+			rows_ahead = uint32_t(std::strtoul(argv[++i], nullptr, 10));
+		} else {
+			std::cerr << "usage: tank-sim [--ticks N] [--tick SECONDS] [--seed N] [--idle | --bot DEPTH [--bot-nodes N]] [--rows-ahead N]" << std::endl;
+			return 1;
+		}
+	}
+	if (!(tick > 0.0f)) {
+		std::cerr << "tick length must be positive." << std::endl;
+		return 1;
+	}
+
+	//random key presses, so the player moves and shoots like a (very bad) human:
+	Pcg32 input_rng(seed, 1); //(a different stream than the sim uses, so input and enemies are independent)
+	std::uniform_int_distribution< uint32_t > key_dist(0, 59);
+
+	uint64_t games = 0;
+	uint64_t score_total = 0;
+	uint32_t score_max = 0;
+
+	//game g is seeded with seed + g, so every game is different but the whole run is repeatable:
+	std::unique_ptr< RowGenerator > row_generator;
+	if (rows_ahead) row_generator.reset(new RowGenerator(seed, rows_ahead));
+	TankSim sim(glm::vec2(3.0f, 7.0f), seed, TankTuning(), row_generator.get());
+
+	//row generator stats, summed over games:
+	uint64_t row_pops = 0, row_stalls = 0, row_depth_total = 0, row_worker_waits = 0;
+	uint32_t row_min_depth = ~0U;
+	auto add_row_stats = [&]() {
+		if (!row_generator) return;
+		row_pops += row_generator->pops;
+		row_stalls += row_generator->stalls;
+		row_depth_total += row_generator->depth_total;
+		row_min_depth = std::min(row_min_depth, row_generator->min_depth);
+		row_worker_waits += row_generator->worker_waits.load();
+	};
+
+	auto before = std::chrono::high_resolution_clock::now();
+
+	for (uint64_t t = 0; t < ticks; ++t) {
+		if (use_bot) {
+			bot.act(sim);
+		} else if (!idle) {
+			//release everything, then (sometimes) press one key:
+			sim.left_up();
+			sim.right_up();
+			sim.shoot_up();
+			uint32_t key = key_dist(input_rng);
+			if (key == 0) sim.left_down();
+			else if (key == 1) sim.right_down();
+			else if (key == 2) sim.shoot_down();
+		}
+
+		sim.update(tick);
+
+		if (sim.game_freeze) {
+			games += 1;
+			score_total += sim.score;
+			score_max = std::max(score_max, sim.score);
+			if (row_generator) {
+				add_row_stats();
+				row_generator.reset(new RowGenerator(uint32_t(seed + games), rows_ahead));
+			}
+			sim = TankSim(glm::vec2(3.0f, 7.0f), uint32_t(seed + games), TankTuning(), row_generator.get());
+		}
+	}
+	add_row_stats();
+
+	auto after = std::chrono::high_resolution_clock::now();
+	double seconds = std::chrono::duration< double >(after - before).count();
+
+	std::cout << "Ran " << ticks << " ticks (" << ticks * double(tick) << " simulated seconds) in " << seconds << " seconds: "
+	          << (ticks / seconds) * 1e-6 << " million ticks per second." << std::endl;
+	std::cout << "Finished " << games << " games";
+	if (games) {
+		std::cout << "; mean score " << double(score_total) / games << ", max score " << score_max;
+	}
+	std::cout << "." << std::endl;
+	if (use_bot && bot.decisions) {
+		std::cout << "Bot searched " << bot.nodes_per_second() * 1e-6 << " million nodes per second; "
+		          << bot.seconds_per_decision() * 1e6 << " us per decision (worst " << bot.worst_decision_seconds * 1e6 << " us), mean depth " << bot.mean_depth() << "." << std::endl;
+	}
+
+	if (row_generator) {
+		std::cout << "Row generator: " << row_pops << " rows popped, mean queue depth " << (row_pops ? double(row_depth_total) / row_pops : 0.0)
+		          << " (min " << (row_pops ? row_min_depth : 0) << " of " << row_generator->ring.size() << "), " << row_stalls << " stalls, "
+		          << row_worker_waits << " worker sleeps." << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,195 @@
+//Monte Carlo difficulty tuner for TankSim: plays many headless games with
+// TankBot on every core, for each combination of tuning constants given,
+// and prints survival time and score distributions (one line per combination).
+//
+//usage: tank-tune [--games N] [--threads N] [--seed N] [--max-seconds S]
+//                 [--start-interval A,B,...] [--min-interval ...] [--rows-per-speedup ...]
+//                 [--row-spacing ...] [--max-bullets ...] [--enemies-per-bullet ...]
+//
+//Each tuning option takes a comma-separated list of values; every combination is run.
+//Game g of every combination uses seed + g, so combinations are compared on the same games
+// and results don't depend on the number of threads.
+
+#include "TankSim.hpp"
+#include "TankBot.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+
+struct GameResult {
+	uint64_t ticks = 0; //ticks survived
+	uint32_t score = 0;
+	bool capped = false; //still alive at max_ticks
+};
+
+static GameResult play_game(TankTuning const &tuning, uint32_t seed, float tick, uint64_t max_ticks) {
+	TankSim sim(glm::vec2(3.0f, 7.0f), seed, tuning);
+	TankBot bot;
+	GameResult result;
+	while (!sim.game_freeze && result.ticks < max_ticks) {
+		bot.act(sim);
+		sim.update(tick);
+		result.ticks += 1;
+	}
+	result.score = sim.score;
+	result.capped = !sim.game_freeze;
+	return result;
+}
+
+//parse "a,b,c" into a list of values:
+template< typename T >
+static bool parse_list(std::string const &text, std::vector< T > *values) {
+	values->clear();
+	std::istringstream in(text);
+	std::string item;
+	while (std::getline(in, item, ',')) {
+		std::istringstream item_in(item);
+		T value;
+		if (!(item_in >> value)) return false;
+		values->emplace_back(value);
+	}
+	return !values->empty();
+}
+
+//value at fraction 'f' of the way through sorted 'values':
+template< typename T >
+static T percentile(std::vector< T > const &values, float f) {
+	return values[std::min(values.size() - 1, size_t(f * values.size()))];
+}
+
+int main(int argc, char **argv) {
+	uint32_t games = 1000;
+	uint32_t threads = std::max(1u, std::thread::hardware_concurrency());
+	uint32_t seed = 0;
+	float max_seconds = 600.0f;
+	float tick = 1.0f / 120.0f;
+
+	TankTuning defaults;
+	std::vector< float > start_intervals{defaults.start_interval};
+	std::vector< float > min_intervals{defaults.min_interval};
+	std::vector< float > rows_per_speedups{defaults.rows_per_speedup};
+	std::vector< float > row_spacings{defaults.row_spacing};
+	std::vector< int32_t > max_bullets{defaults.max_bullets};
+	std::vector< int32_t > enemies_per_bullets{defaults.enemies_per_bullet};
+
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		bool ok = (i + 1 < argc);
+		if (!ok) {
+		} else if (arg == "--games") {
+			games = uint32_t(std::strtoul(argv[++i], nullptr, 10));
+		} else if (arg == "--threads") {
+			threads = std::max(1u, uint32_t(std::strtoul(argv[++i], nullptr, 10)));
+		} else if (arg == "--seed") {
+			seed = uint32_t(std::strtoul(argv[++i], nullptr, 10));
+		} else if (arg == "--max-seconds") {
+			max_seconds = std::strtof(argv[++i], nullptr);
+		} else if (arg == "--start-interval") {
+			ok = parse_list(argv[++i], &start_intervals);
+		} else if (arg == "--min-interval") {
+			ok = parse_list(argv[++i], &min_intervals);
+		} else if (arg == "--rows-per-speedup") {
+			ok = parse_list(argv[++i], &rows_per_speedups);
+		} else if (arg == "--row-spacing") {
+			ok = parse_list(argv[++i], &row_spacings);
+		} else if (arg == "--max-bullets") {
+			ok = parse_list(argv[++i], &max_bullets);
+		} else if (arg == "--enemies-per-bullet") {
+			ok = parse_list(argv[++i], &enemies_per_bullets);
+		} else {
+			ok = false;
+		}
+		if (!ok) {
+			std::cerr << "usage: tank-tune [--games N] [--threads N] [--seed N] [--max-seconds S]\n"
+			             "                 [--start-interval A,B,...] [--min-interval ...] [--rows-per-speedup ...]\n"
+			             "                 [--row-spacing ...] [--max-bullets ...] [--enemies-per-bullet ...]" << std::endl;
+			return 1;
+		}
+	}
+	if (games == 0 || !(max_seconds > 0.0f)) {
+		std::cerr << "Need at least one game and a positive --max-seconds." << std::endl;
+		return 1;
+	}
+	for (int32_t v : enemies_per_bullets) {
+		if (v <= 0) {
+			std::cerr << "--enemies-per-bullet values must be positive." << std::endl;
+			return 1;
+		}
+	}
+	uint64_t max_ticks = uint64_t(max_seconds / tick);
+
+	//every combination of the tuning values:
+	std::vector< TankTuning > tunings;
+	for (float a : start_intervals) for (float b : min_intervals) for (float c : rows_per_speedups)
+	for (float d : row_spacings) for (int32_t e : max_bullets) for (int32_t f : enemies_per_bullets) {
+		TankTuning tuning;
+		tuning.start_interval = a;
+		tuning.min_interval = b;
+		tuning.rows_per_speedup = c;
+		tuning.row_spacing = d;
+		tuning.max_bullets = e;
+		tuning.enemies_per_bullet = f;
+		tunings.emplace_back(tuning);
+	}
+
+	std::cout << "# " << tunings.size() << " tunings x " << games << " games on " << threads << " threads; seeds " << seed << "+; games stop at " << max_seconds << " seconds\n";
+	std::cout << "#start_interval\tmin_interval\trows_per_speedup\trow_spacing\tmax_bullets\tenemies_per_bullet"
+	             "\tseconds_mean\tseconds_p10\tseconds_p50\tseconds_p90\tcapped"
+	             "\tscore_mean\tscore_p10\tscore_p50\tscore_p90\tscore_max\twall_seconds" << std::endl;
+
+	std::vector< GameResult > results(games);
+	for (TankTuning const &tuning : tunings) {
+		auto before = std::chrono::high_resolution_clock::now();
+
+		//workers take games in order until there are none left:
+		std::atomic< uint32_t > next_game(0);
+		auto work = [&]() {
+			for (uint32_t g = next_game++; g < games; g = next_game++) {
+				results[g] = play_game(tuning, seed + g, tick, max_ticks);
+			}
+		};
+		std::vector< std::thread > workers;
+		for (uint32_t t = 1; t < threads; ++t) {
+			workers.emplace_back(work);
+		}
+		work();
+		for (auto &worker : workers) {
+			worker.join();
+		}
+
+		double wall = std::chrono::duration< double >(std::chrono::high_resolution_clock::now() - before).count();
+
+		std::vector< float > seconds;
+		std::vector< uint32_t > scores;
+		seconds.reserve(games);
+		scores.reserve(games);
+		double seconds_sum = 0.0;
+		double score_sum = 0.0;
+		uint32_t capped = 0;
+		for (GameResult const &result : results) {
+			seconds.emplace_back(result.ticks * tick);
+			scores.emplace_back(result.score);
+			seconds_sum += seconds.back();
+			score_sum += result.score;
+			capped += (result.capped ? 1 : 0);
+		}
+		std::sort(seconds.begin(), seconds.end());
+		std::sort(scores.begin(), scores.end());
+
+		std::cout << tuning.start_interval << '\t' << tuning.min_interval << '\t' << tuning.rows_per_speedup << '\t'
+		          << tuning.row_spacing << '\t' << tuning.max_bullets << '\t' << tuning.enemies_per_bullet << '\t'
+		          << seconds_sum / games << '\t' << percentile(seconds, 0.1f) << '\t' << percentile(seconds, 0.5f) << '\t' << percentile(seconds, 0.9f) << '\t' << capped << '\t'
+		          << score_sum / games << '\t' << percentile(scores, 0.1f) << '\t' << percentile(scores, 0.5f) << '\t' << percentile(scores, 0.9f) << '\t' << scores.back() << '\t'
+		          << wall << std::endl;
+	}
+
+	return 0;
+}